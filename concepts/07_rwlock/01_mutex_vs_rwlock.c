@@ -3,12 +3,19 @@
  * 
  * Compares mutex vs rwlock performance for read-heavy workload.
  * 
+ * Third contender: a big-reader lock (brlock). pthread_rwlock keeps
+ * ONE shared reader count, so every rdlock/unlock writes the same
+ * cache line. The brlock gives each reader its own cache-line slot:
+ * readers only touch their slot, writers scan all slots.
+ * 
  * Compile: gcc -pthread 01_mutex_vs_rwlock.c -o 01_mutex_vs_rwlock
  * Run: ./01_mutex_vs_rwlock
  */
 
 #include <stdio.h>
 #include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -63,6 +70,76 @@ void* writer_rwlock(void* arg) {
     return NULL;
 }
 
+/* Big-reader lock version: one padded slot per reader */
+typedef struct {
+    _Alignas(64) atomic_int active;  /* own cache line per reader */
+} br_slot_t;
+
+typedef struct {
+    br_slot_t slots[NUM_READERS];
+    atomic_int writer_active;
+    pthread_mutex_t writer;          /* serializes writers */
+} brlock_t;
+
+brlock_t brlock = { .writer = PTHREAD_MUTEX_INITIALIZER };
+
+void br_read_lock(brlock_t *br, int id) {
+    for (;;) {
+        /* seq_cst store then load: pairs with the writer's store then
+         * scan, so either we see the writer or it sees our slot */
+        atomic_store(&br->slots[id].active, 1);
+        if (!atomic_load(&br->writer_active)) {
+            return;
+        }
+        /* Writer inside or waiting: back off until it is done */
+        atomic_store(&br->slots[id].active, 0);
+        while (atomic_load(&br->writer_active)) {
+            sched_yield();
+        }
+    }
+}
+
+void br_read_unlock(brlock_t *br, int id) {
+    atomic_store_explicit(&br->slots[id].active, 0, memory_order_release);
+}
+
+void br_write_lock(brlock_t *br) {
+    pthread_mutex_lock(&br->writer);
+    atomic_store(&br->writer_active, 1);
+    /* Wait for every reader slot to drain - cost grows with readers */
+    for (int i = 0; i < NUM_READERS; i++) {
+        while (atomic_load(&br->slots[i].active)) {
+            sched_yield();
+        }
+    }
+}
+
+void br_write_unlock(brlock_t *br) {
+    atomic_store_explicit(&br->writer_active, 0, memory_order_release);
+    pthread_mutex_unlock(&br->writer);
+}
+
+void* reader_brlock(void* arg) {
+    int id = *(int*)arg;
+    for (int i = 0; i < ITERATIONS; i++) {
+        br_read_lock(&brlock, id);
+        volatile int value = shared_data;  // Read
+        (void)value;
+        br_read_unlock(&brlock, id);
+    }
+    return NULL;
+}
+
+void* writer_brlock(void* arg) {
+    (void)arg;
+    for (int i = 0; i < ITERATIONS; i++) {
+        br_write_lock(&brlock);
+        shared_data++;  // Write
+        br_write_unlock(&brlock);
+    }
+    return NULL;
+}
+
 double benchmark_mutex(void) {
     pthread_t readers[NUM_READERS];
     pthread_t writers[NUM_WRITERS];
@@ -125,6 +202,39 @@ double benchmark_rwlock(void) {
            (end.tv_nsec - start.tv_nsec) / 1e9;
 }
 
+double benchmark_brlock(void) {
+    pthread_t readers[NUM_READERS];
+    pthread_t writers[NUM_WRITERS];
+    int reader_ids[NUM_READERS];
+    
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    /* Create reader threads (each owns one brlock slot) */
+    for (int i = 0; i < NUM_READERS; i++) {
+        reader_ids[i] = i;
+        pthread_create(&readers[i], NULL, reader_brlock, &reader_ids[i]);
+    }
+    
+    /* Create writer threads */
+    for (int i = 0; i < NUM_WRITERS; i++) {
+        pthread_create(&writers[i], NULL, writer_brlock, NULL);
+    }
+    
+    /* Wait for all threads */
+    for (int i = 0; i < NUM_READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+    for (int i = 0; i < NUM_WRITERS; i++) {
+        pthread_join(writers[i], NULL);
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    
+    return (end.tv_sec - start.tv_sec) + 
+           (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
 int main(void) {
     printf("=== Mutex vs Read-Write Lock Performance ===\n\n");
     printf("Workload: %d readers, %d writers\n", NUM_READERS, NUM_WRITERS);
@@ -141,6 +251,11 @@ int main(void) {
     double time_rwlock = benchmark_rwlock();
     printf("Rwlock: %.3f seconds\n", time_rwlock);
     
+    /* Benchmark big-reader lock */
+    shared_data = 0;
+    double time_brlock = benchmark_brlock();
+    printf("Brlock: %.3f seconds\n", time_brlock);
+    
     printf("\n=== Results ===\n");
     if (time_rwlock < time_mutex) {
         printf("✅ Rwlock is %.2fx FASTER\n", time_mutex / time_rwlock);
@@ -154,14 +269,24 @@ int main(void) {
         printf("3. Only 80%% reads - need 90%%+ for rwlock to win\n");
     }
     
+    printf("\nBrlock vs rwlock: %.2fx %s\n",
+           time_brlock < time_rwlock ? time_rwlock / time_brlock : time_brlock / time_rwlock,
+           time_brlock < time_rwlock ? "faster" : "slower");
+    
     printf("\n=== Why Rwlock Wins ===\n");
     printf("Mutex:  Only 1 thread at a time (even readers!)\n");
     printf("Rwlock: %d readers can read simultaneously\n", NUM_READERS);
     printf("        Writers still exclusive (1 at a time)\n");
     
+    printf("\n=== Big-Reader Lock ===\n");
+    printf("Rwlock: all readers update ONE shared counter (cache line bounces)\n");
+    printf("Brlock: each reader writes only its OWN padded slot\n");
+    printf("        Writer must scan all %d slots - writes get more expensive\n", NUM_READERS);
+    
     printf("\n=== When to Use Each ===\n");
     printf("Mutex:  Write-heavy, short critical sections, simple\n");
     printf("Rwlock: Read-heavy (90%%+ reads), longer critical sections\n");
+    printf("Brlock: Extreme read-heavy (99%%+), many cores, rare writes\n");
     printf("\n=== Key Lesson ===\n");
     printf("Rwlock has overhead! Only use when:\n");
     printf("  • 90%%+ reads (not just 80%%)\n");
@@ -177,10 +302,21 @@ int main(void) {
  * Mutex:  2.5 seconds
  * Rwlock: 0.8 seconds
  * 
+ * Brlock: depends on core count (see below)
+ * 
  * Rwlock is 3x FASTER!
  * 
  * WHY?
  * - Mutex: 10 threads serialize (1 at a time)
  * - Rwlock: 8 readers concurrent, 2 writers serialize
  * - Result: Much better throughput!
+ * 
+ * BRLOCK:
+ * - Readers never share a cache line, so read cost stays flat as
+ *   cores are added (the shared rwlock counter does not).
+ * - Writers pay O(readers) to scan slots, and this workload has
+ *   2 writers doing as many ops as each reader - a bad case for it.
+ * - Slots here are per reader THREAD. The kernel's per-CPU version
+ *   (lglock / percpu_rw_semaphore) indexes by CPU with preemption off;
+ *   user space can't pin that cheaply, so per-thread slots are used.
  */
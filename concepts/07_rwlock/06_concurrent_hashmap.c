@@ -0,0 +1,693 @@
+/**
+ * 06_concurrent_hashmap.c - Striped Hash Map with Seqlock Readers
+ *
+ * 04_lookup_table.c puts 10 chained buckets behind ONE rwlock.
+ * That has two scaling problems:
+ *   - Every lookup writes the shared rwlock word (reader count),
+ *     so the lock's cache line bounces between all reader CPUs.
+ *   - 10 fixed buckets: chains grow linearly with the key count.
+ *
+ * This version:
+ *   - Splits the map into 64 segments, chosen by the top hash bits.
+ *   - Each segment is a resizable open-addressing table (linear
+ *     probing, tombstones for delete) with its OWN writer mutex.
+ *   - Readers take no lock at all: they read a per-segment sequence
+ *     counter, probe, and re-check the counter (seqlock). If a writer
+ *     touched the segment meanwhile, they simply retry.
+ *   - Resized arrays are retired, not freed, so a reader still
+ *     probing the old array never touches freed memory.
+ *
+ * Benchmark: 90% lookup / 9% insert / 1% remove at 1..32 threads for
+ *   1. 04 design  (10 chains + global rwlock)
+ *   2. rwlock + open addressing (same table as 3, one global rwlock)
+ *   3. striped + seqlock readers
+ *
+ * Compile: gcc -Wall -Wextra -pthread -std=c11 -D_XOPEN_SOURCE=700 06_concurrent_hashmap.c -o 06_concurrent_hashmap
+ * Run: ./06_concurrent_hashmap
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NUM_SEGMENTS     64
+#define SEGMENT_SHIFT    26          /* top 6 hash bits pick the segment */
+#define SEGMENT_INIT_CAP 16          /* slots, power of two */
+#define CHAIN_BUCKETS    10          /* 04_lookup_table.c's TABLE_SIZE */
+
+#define KEY_EMPTY 0u
+#define KEY_TOMB  0xFFFFFFFFu
+#define KEY_RANGE 65535u             /* keys are 1..KEY_RANGE */
+#define PRELOAD   16384
+
+#define BENCH_MS  200
+#define MAX_THREADS 32
+
+/* ===== HASH ===== */
+
+static inline uint32_t mix32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+/* ===== STRIPED OPEN-ADDRESSING MAP ===== */
+
+typedef struct {
+    _Atomic uint32_t key;
+    _Atomic int32_t value;
+} slot_t;
+
+/* One probe array. cap never changes after publication. */
+typedef struct slot_array {
+    struct slot_array *retired;      /* older arrays, freed at destroy */
+    uint32_t cap;
+    slot_t slot[];
+} slot_array_t;
+
+typedef struct {
+    _Alignas(64) _Atomic unsigned seq;   /* odd = writer inside */
+    _Atomic(slot_array_t *) array;
+    pthread_mutex_t lock;
+    uint32_t used;                   /* live + tombstones (writer only) */
+    uint32_t live;
+} segment_t;
+
+typedef struct {
+    segment_t seg[NUM_SEGMENTS];
+} hashmap_t;
+
+static slot_array_t *array_alloc(uint32_t cap) {
+    slot_array_t *a = calloc(1, sizeof(*a) + cap * sizeof(slot_t));
+    if (!a) {
+        perror("calloc");
+        exit(1);
+    }
+    a->cap = cap;
+    return a;
+}
+
+void hm_init(hashmap_t *m) {
+    for (int i = 0; i < NUM_SEGMENTS; i++) {
+        segment_t *s = &m->seg[i];
+        atomic_init(&s->seq, 0);
+        atomic_init(&s->array, array_alloc(SEGMENT_INIT_CAP));
+        pthread_mutex_init(&s->lock, NULL);
+        s->used = 0;
+        s->live = 0;
+    }
+}
+
+void hm_destroy(hashmap_t *m) {
+    for (int i = 0; i < NUM_SEGMENTS; i++) {
+        slot_array_t *a = atomic_load(&m->seg[i].array);
+        while (a) {
+            slot_array_t *older = a->retired;
+            free(a);
+            a = older;
+        }
+        pthread_mutex_destroy(&m->seg[i].lock);
+    }
+}
+
+/* Writer side of the seqlock (caller holds s->lock) */
+static inline void seq_write_begin(segment_t *s) {
+    unsigned v = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    atomic_store_explicit(&s->seq, v + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void seq_write_end(segment_t *s) {
+    unsigned v = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    atomic_store_explicit(&s->seq, v + 1, memory_order_release);
+}
+
+/* Lock-free lookup: returns 1 and fills *value if found */
+int hm_lookup(hashmap_t *m, uint32_t key, int32_t *value) {
+    uint32_t h = mix32(key);
+    segment_t *s = &m->seg[h >> SEGMENT_SHIFT];
+    int spins = 0;
+
+    for (;;) {
+        unsigned start = atomic_load_explicit(&s->seq, memory_order_acquire);
+        if (start & 1) {
+            /* Writer inside; on an oversubscribed CPU let it finish */
+            if (++spins > 64) {
+                sched_yield();
+                spins = 0;
+            }
+            continue;
+        }
+
+        slot_array_t *a = atomic_load_explicit(&s->array, memory_order_acquire);
+        uint32_t mask = a->cap - 1;
+        int found = 0;
+        int32_t v = 0;
+
+        /* Bounded probe: a torn view can never loop forever */
+        for (uint32_t i = h & mask, n = 0; n <= mask; i = (i + 1) & mask, n++) {
+            uint32_t k = atomic_load_explicit(&a->slot[i].key, memory_order_relaxed);
+            if (k == KEY_EMPTY) {
+                break;
+            }
+            if (k == key) {
+                v = atomic_load_explicit(&a->slot[i].value, memory_order_relaxed);
+                found = 1;
+                break;
+            }
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&s->seq, memory_order_relaxed) == start) {
+            if (found) {
+                *value = v;
+            }
+            return found;
+        }
+        /* Segment changed under us: retry */
+    }
+}
+
+/* Rehash live entries into a fresh array (caller inside seq_write) */
+static void segment_resize(segment_t *s) {
+    slot_array_t *old = atomic_load_explicit(&s->array, memory_order_relaxed);
+    uint32_t cap = old->cap;
+
+    /* Grow if live entries would pass 1/2, else just drop tombstones */
+    if ((s->live + 1) * 2 > cap) {
+        cap *= 2;
+    }
+
+    slot_array_t *a = array_alloc(cap);
+    uint32_t mask = cap - 1;
+
+    for (uint32_t i = 0; i < old->cap; i++) {
+        uint32_t k = atomic_load_explicit(&old->slot[i].key, memory_order_relaxed);
+        if (k == KEY_EMPTY || k == KEY_TOMB) {
+            continue;
+        }
+        uint32_t j = mix32(k) & mask;
+        while (atomic_load_explicit(&a->slot[j].key, memory_order_relaxed) != KEY_EMPTY) {
+            j = (j + 1) & mask;
+        }
+        atomic_store_explicit(&a->slot[j].value,
+            atomic_load_explicit(&old->slot[i].value, memory_order_relaxed),
+            memory_order_relaxed);
+        atomic_store_explicit(&a->slot[j].key, k, memory_order_relaxed);
+    }
+
+    a->retired = old;
+    s->used = s->live;
+    atomic_store_explicit(&s->array, a, memory_order_release);
+}
+
+void hm_insert(hashmap_t *m, uint32_t key, int32_t value) {
+    uint32_t h = mix32(key);
+    segment_t *s = &m->seg[h >> SEGMENT_SHIFT];
+
+    pthread_mutex_lock(&s->lock);
+
+    /* Search under the writer lock; readers never modify, so no seq bump */
+    slot_array_t *a = atomic_load_explicit(&s->array, memory_order_relaxed);
+    uint32_t mask = a->cap - 1;
+    uint32_t i = h & mask;
+    int64_t tomb = -1;
+
+    for (;;) {
+        uint32_t k = atomic_load_explicit(&a->slot[i].key, memory_order_relaxed);
+        if (k == key) {
+            seq_write_begin(s);
+            atomic_store_explicit(&a->slot[i].value, value, memory_order_relaxed);
+            seq_write_end(s);
+            pthread_mutex_unlock(&s->lock);
+            return;
+        }
+        if (k == KEY_TOMB && tomb < 0) {
+            tomb = i;
+        }
+        if (k == KEY_EMPTY) {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+
+    seq_write_begin(s);
+
+    if (tomb >= 0) {
+        i = (uint32_t)tomb;              /* reuse: used count unchanged */
+    } else if ((s->used + 1) * 4 > a->cap * 3) {
+        segment_resize(s);               /* keep load factor <= 3/4 */
+        a = atomic_load_explicit(&s->array, memory_order_relaxed);
+        mask = a->cap - 1;
+        i = h & mask;
+        while (atomic_load_explicit(&a->slot[i].key, memory_order_relaxed) != KEY_EMPTY) {
+            i = (i + 1) & mask;
+        }
+        s->used++;
+    } else {
+        s->used++;
+    }
+
+    atomic_store_explicit(&a->slot[i].value, value, memory_order_relaxed);
+    atomic_store_explicit(&a->slot[i].key, key, memory_order_relaxed);
+    s->live++;
+
+    seq_write_end(s);
+    pthread_mutex_unlock(&s->lock);
+}
+
+int hm_remove(hashmap_t *m, uint32_t key) {
+    uint32_t h = mix32(key);
+    segment_t *s = &m->seg[h >> SEGMENT_SHIFT];
+
+    pthread_mutex_lock(&s->lock);
+
+    slot_array_t *a = atomic_load_explicit(&s->array, memory_order_relaxed);
+    uint32_t mask = a->cap - 1;
+
+    for (uint32_t i = h & mask; ; i = (i + 1) & mask) {
+        uint32_t k = atomic_load_explicit(&a->slot[i].key, memory_order_relaxed);
+        if (k == KEY_EMPTY) {
+            break;
+        }
+        if (k == key) {
+            seq_write_begin(s);
+            atomic_store_explicit(&a->slot[i].key, KEY_TOMB, memory_order_relaxed);
+            s->live--;
+            seq_write_end(s);
+            pthread_mutex_unlock(&s->lock);
+            return 1;
+        }
+    }
+
+    pthread_mutex_unlock(&s->lock);
+    return 0;
+}
+
+/* ===== BASELINE: 04_lookup_table.c DESIGN ===== */
+
+/* Same shape as 04 (10 chains, one rwlock), integer keys instead of
+ * strings so the comparison measures locking and layout, not strcmp. */
+typedef struct chain_entry {
+    uint32_t key;
+    int32_t value;
+    struct chain_entry *next;
+} chain_entry_t;
+
+typedef struct {
+    pthread_rwlock_t lock;
+    chain_entry_t *buckets[CHAIN_BUCKETS];
+} chain_table_t;
+
+void chain_init(chain_table_t *t) {
+    pthread_rwlock_init(&t->lock, NULL);
+    for (int i = 0; i < CHAIN_BUCKETS; i++) {
+        t->buckets[i] = NULL;
+    }
+}
+
+void chain_destroy(chain_table_t *t) {
+    for (int i = 0; i < CHAIN_BUCKETS; i++) {
+        chain_entry_t *e = t->buckets[i];
+        while (e) {
+            chain_entry_t *next = e->next;
+            free(e);
+            e = next;
+        }
+    }
+    pthread_rwlock_destroy(&t->lock);
+}
+
+int chain_lookup(chain_table_t *t, uint32_t key, int32_t *value) {
+    int found = 0;
+    pthread_rwlock_rdlock(&t->lock);
+    for (chain_entry_t *e = t->buckets[key % CHAIN_BUCKETS]; e; e = e->next) {
+        if (e->key == key) {
+            *value = e->value;
+            found = 1;
+            break;
+        }
+    }
+    pthread_rwlock_unlock(&t->lock);
+    return found;
+}
+
+void chain_insert(chain_table_t *t, uint32_t key, int32_t value) {
+    pthread_rwlock_wrlock(&t->lock);
+    chain_entry_t **head = &t->buckets[key % CHAIN_BUCKETS];
+    for (chain_entry_t *e = *head; e; e = e->next) {
+        if (e->key == key) {
+            e->value = value;
+            pthread_rwlock_unlock(&t->lock);
+            return;
+        }
+    }
+    chain_entry_t *e = malloc(sizeof(*e));
+    if (!e) {
+        perror("malloc");
+        exit(1);
+    }
+    e->key = key;
+    e->value = value;
+    e->next = *head;
+    *head = e;
+    pthread_rwlock_unlock(&t->lock);
+}
+
+int chain_remove(chain_table_t *t, uint32_t key) {
+    pthread_rwlock_wrlock(&t->lock);
+    for (chain_entry_t **pp = &t->buckets[key % CHAIN_BUCKETS]; *pp; pp = &(*pp)->next) {
+        if ((*pp)->key == key) {
+            chain_entry_t *dead = *pp;
+            *pp = dead->next;
+            free(dead);
+            pthread_rwlock_unlock(&t->lock);
+            return 1;
+        }
+    }
+    pthread_rwlock_unlock(&t->lock);
+    return 0;
+}
+
+/* ===== BENCHMARK ===== */
+
+typedef enum {
+    DESIGN_CHAIN_RWLOCK,
+    DESIGN_OPEN_RWLOCK,
+    DESIGN_STRIPED_SEQLOCK,
+    NUM_DESIGNS
+} design_t;
+
+static const char *design_names[NUM_DESIGNS] = {
+    "04 design (10 chains + rwlock)",
+    "rwlock + open addressing",
+    "striped + seqlock readers",
+};
+
+typedef struct {
+    design_t design;
+    hashmap_t map;
+    chain_table_t chain;
+    pthread_rwlock_t global;         /* only for DESIGN_OPEN_RWLOCK */
+    pthread_barrier_t start;
+    atomic_bool stop;
+} bench_t;
+
+typedef struct {
+    bench_t *bench;
+    uint32_t rng;
+    uint64_t lookups;
+    uint64_t inserts;
+    uint64_t removes;
+    uint64_t torn;                   /* value does not belong to key */
+} worker_t;
+
+static inline uint32_t xorshift32(uint32_t *s) {
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+/* Low 16 bits carry the key so readers can detect a torn value */
+static inline int32_t make_value(uint32_t key, uint32_t gen) {
+    return (int32_t)(((gen & 0x7FFF) << 16) | key);
+}
+
+static int bench_lookup(bench_t *b, uint32_t key, int32_t *v) {
+    switch (b->design) {
+    case DESIGN_CHAIN_RWLOCK:
+        return chain_lookup(&b->chain, key, v);
+    case DESIGN_OPEN_RWLOCK: {
+        pthread_rwlock_rdlock(&b->global);
+        int found = hm_lookup(&b->map, key, v);
+        pthread_rwlock_unlock(&b->global);
+        return found;
+    }
+    default:
+        return hm_lookup(&b->map, key, v);
+    }
+}
+
+static void bench_insert(bench_t *b, uint32_t key, int32_t v) {
+    switch (b->design) {
+    case DESIGN_CHAIN_RWLOCK:
+        chain_insert(&b->chain, key, v);
+        break;
+    case DESIGN_OPEN_RWLOCK:
+        pthread_rwlock_wrlock(&b->global);
+        hm_insert(&b->map, key, v);
+        pthread_rwlock_unlock(&b->global);
+        break;
+    default:
+        hm_insert(&b->map, key, v);
+        break;
+    }
+}
+
+static void bench_remove(bench_t *b, uint32_t key) {
+    switch (b->design) {
+    case DESIGN_CHAIN_RWLOCK:
+        chain_remove(&b->chain, key);
+        break;
+    case DESIGN_OPEN_RWLOCK:
+        pthread_rwlock_wrlock(&b->global);
+        hm_remove(&b->map, key);
+        pthread_rwlock_unlock(&b->global);
+        break;
+    default:
+        hm_remove(&b->map, key);
+        break;
+    }
+}
+
+void* worker_thread(void* arg) {
+    worker_t *w = arg;
+    bench_t *b = w->bench;
+    uint32_t gen = 0;
+
+    pthread_barrier_wait(&b->start);
+
+    while (!atomic_load_explicit(&b->stop, memory_order_relaxed)) {
+        uint32_t r = xorshift32(&w->rng);
+        uint32_t key = 1 + (r >> 8) % KEY_RANGE;
+        uint32_t op = r % 100;
+
+        if (op < 90) {
+            int32_t v;
+            if (bench_lookup(b, key, &v) && (uint32_t)(v & 0xFFFF) != key) {
+                w->torn++;
+            }
+            w->lookups++;
+        } else if (op < 99) {
+            bench_insert(b, key, make_value(key, ++gen));
+            w->inserts++;
+        } else {
+            bench_remove(b, key);
+            w->removes++;
+        }
+    }
+    return NULL;
+}
+
+typedef struct {
+    double lookup_mops;
+    double insert_kops;
+    uint64_t torn;
+} result_t;
+
+result_t run_bench(design_t design, int nthreads) {
+    static bench_t b;
+    pthread_t threads[MAX_THREADS];
+    worker_t workers[MAX_THREADS];
+    struct timespec start, end;
+    struct timespec run = { .tv_sec = 0, .tv_nsec = BENCH_MS * 1000000L };
+
+    b.design = design;
+    atomic_init(&b.stop, false);
+    hm_init(&b.map);
+    chain_init(&b.chain);
+    pthread_rwlock_init(&b.global, NULL);
+    pthread_barrier_init(&b.start, NULL, nthreads + 1);
+
+    /* Same preload for every design */
+    uint32_t seed = 12345;
+    for (int i = 0; i < PRELOAD; i++) {
+        uint32_t key = 1 + (xorshift32(&seed) >> 8) % KEY_RANGE;
+        if (design == DESIGN_CHAIN_RWLOCK) {
+            chain_insert(&b.chain, key, make_value(key, 0));
+        } else {
+            hm_insert(&b.map, key, make_value(key, 0));
+        }
+    }
+
+    for (int i = 0; i < nthreads; i++) {
+        workers[i] = (worker_t){ .bench = &b, .rng = 0x9E3779B9u * (i + 1) };
+        pthread_create(&threads[i], NULL, worker_thread, &workers[i]);
+    }
+
+    pthread_barrier_wait(&b.start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    nanosleep(&run, NULL);
+    atomic_store(&b.stop, true);
+
+    for (int i = 0; i < nthreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double secs = (end.tv_sec - start.tv_sec) +
+                  (end.tv_nsec - start.tv_nsec) / 1e9;
+    result_t r = {0};
+    uint64_t lookups = 0, inserts = 0;
+    for (int i = 0; i < nthreads; i++) {
+        lookups += workers[i].lookups;
+        inserts += workers[i].inserts;
+        r.torn += workers[i].torn;
+    }
+    r.lookup_mops = lookups / secs / 1e6;
+    r.insert_kops = inserts / secs / 1e3;
+
+    pthread_barrier_destroy(&b.start);
+    pthread_rwlock_destroy(&b.global);
+    chain_destroy(&b.chain);
+    hm_destroy(&b.map);
+    return r;
+}
+
+/* ===== SANITY CHECK ===== */
+
+int sanity_check(void) {
+    static hashmap_t m;
+    int errors = 0;
+    int32_t v;
+
+    hm_init(&m);
+    for (uint32_t k = 1; k <= KEY_RANGE; k++) {
+        hm_insert(&m, k, make_value(k, 1));
+    }
+    for (uint32_t k = 2; k <= KEY_RANGE; k += 2) {
+        hm_remove(&m, k);
+    }
+    for (uint32_t k = 1; k <= KEY_RANGE; k++) {
+        int found = hm_lookup(&m, k, &v);
+        if ((k & 1) != (uint32_t)found || (found && v != make_value(k, 1))) {
+            errors++;
+        }
+    }
+    hm_destroy(&m);
+    return errors;
+}
+
+int main(void) {
+    static const int thread_counts[] = {1, 2, 4, 8, 16, 32};
+    const int n = sizeof(thread_counts) / sizeof(thread_counts[0]);
+    result_t results[NUM_DESIGNS][6];
+    uint64_t torn_total = 0;
+
+    printf("=== Concurrent Hash Map: Striped Segments + Seqlock Readers ===\n\n");
+    printf("Online CPUs: %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("Keys: 1..%u, preload %d, %d segments\n", KEY_RANGE, PRELOAD, NUM_SEGMENTS);
+    printf("Mix: 90%% lookup / 9%% insert / 1%% remove, %d ms per run\n\n", BENCH_MS);
+
+    int errors = sanity_check();
+    printf("Sanity check (insert all, remove evens): %s\n\n",
+           errors ? "FAILED" : "ok");
+
+    for (int d = 0; d < NUM_DESIGNS; d++) {
+        for (int i = 0; i < n; i++) {
+            results[d][i] = run_bench((design_t)d, thread_counts[i]);
+            torn_total += results[d][i].torn;
+        }
+    }
+
+    printf("Lookup throughput (Mops/s):\n");
+    printf("%-8s", "threads");
+    for (int d = 0; d < NUM_DESIGNS; d++) {
+        printf(" | %-30s", design_names[d]);
+    }
+    printf("\n");
+    for (int i = 0; i < n; i++) {
+        printf("%-8d", thread_counts[i]);
+        for (int d = 0; d < NUM_DESIGNS; d++) {
+            printf(" | %-30.2f", results[d][i].lookup_mops);
+        }
+        printf("\n");
+    }
+
+    printf("\nInsert throughput (Kops/s):\n");
+    printf("%-8s", "threads");
+    for (int d = 0; d < NUM_DESIGNS; d++) {
+        printf(" | %-30s", design_names[d]);
+    }
+    printf("\n");
+    for (int i = 0; i < n; i++) {
+        printf("%-8d", thread_counts[i]);
+        for (int d = 0; d < NUM_DESIGNS; d++) {
+            printf(" | %-30.1f", results[d][i].insert_kops);
+        }
+        printf("\n");
+    }
+
+    printf("\nTorn reads (value from another key): %llu\n",
+           (unsigned long long)torn_total);
+
+    printf("\n=== Results ===\n");
+    for (int i = 0; i < n; i++) {
+        printf("%2d threads: striped lookups %.1fx vs 04 design, %.1fx vs global rwlock\n",
+               thread_counts[i],
+               results[DESIGN_STRIPED_SEQLOCK][i].lookup_mops /
+                   results[DESIGN_CHAIN_RWLOCK][i].lookup_mops,
+               results[DESIGN_STRIPED_SEQLOCK][i].lookup_mops /
+                   results[DESIGN_OPEN_RWLOCK][i].lookup_mops);
+    }
+
+    printf("\n=== Why It Scales ===\n");
+    printf("✅ Lookups write nothing shared - no rwlock reader count to bounce\n");
+    printf("✅ Writers lock 1 of %d segments, not the whole table\n", NUM_SEGMENTS);
+    printf("✅ Open addressing: short probes in one array, no pointer chasing\n");
+    printf("✅ Segments grow independently; load factor stays <= 3/4\n");
+    printf("✅ Seqlock retry means readers never return a torn key/value pair\n");
+
+    return errors ? 1 : 0;
+}
+
+/*
+ * DESIGN NOTES:
+ *
+ * 1. Why a seqlock and not per-segment rwlocks?
+ *    - rdlock/unlock are atomic RMWs on the lock word. With many CPUs
+ *      the lock line ping-pongs even though readers never conflict.
+ *    - Seqlock readers only LOAD the counter, so the line stays shared
+ *      in every reader's cache until a writer touches that segment.
+ *
+ * 2. Why retire old arrays instead of freeing them?
+ *    - A reader may still be probing the old array after a resize.
+ *      The seqlock tells it to retry, but it must not fault first.
+ *    - Retired arrays are at most the sum of a geometric series
+ *      (< 1x the live array). Production code would use RCU or
+ *      hazard pointers to free them (see 10_config_rcu.c in
+ *      system_design/01_layered_architecture).
+ *
+ * 3. Why relaxed atomics for key/value?
+ *    - A seqlock reader races with the writer by design. Plain loads
+ *      would be a C11 data race (undefined behaviour); relaxed atomic
+ *      loads cost the same as plain loads on x86 and ARM.
+ *
+ * 4. Reading the numbers
+ *    - On a single CPU every design is serialised, so the thread
+ *      sweep mostly shows oversubscription cost, and the gap comes
+ *      from layout (10 long chains vs short probes) and lock overhead.
+ *    - On a many-core machine the global rwlock flattens as threads
+ *      are added, while striped lookups keep scaling.
+ */
@@ -0,0 +1,289 @@
+/**
+ * 07_seqlock_config.c - Seqlock for a Read-Mostly Config Cache
+ *
+ * 02_config_cache.c takes pthread_rwlock_rdlock on every read.
+ * rdlock is an atomic WRITE to the shared lock word (reader count),
+ * so with many readers the lock's cache line bounces between CPUs
+ * even though readers never conflict with each other.
+ *
+ * A seqlock fixes this for small structs:
+ *   - Writers: lock, seq++ (odd), update, seq++ (even), unlock
+ *   - Readers: read seq, copy data, re-read seq. If seq was odd or
+ *     changed, a writer was active -> retry. Readers write NOTHING.
+ *
+ * This file:
+ *   1. Seqlock primitive (seqlock_t)
+ *   2. Config cache {port, timeout_ms, max_connections} ported to it
+ *   3. Mutex vs rwlock vs seqlock, same harness as 01_mutex_vs_rwlock.c,
+ *      with a consistency check on every read
+ *
+ * Compile: gcc -Wall -Wextra -pthread -std=c11 -D_XOPEN_SOURCE=700 07_seqlock_config.c -o 07_seqlock_config
+ * Run: ./07_seqlock_config
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define NUM_READERS 8
+#define NUM_WRITERS 1
+#define ITERATIONS 1000000
+#define WRITE_EVERY 1000             /* writer: 1 update per 1000 reads */
+
+/* ===== SEQLOCK PRIMITIVE ===== */
+
+typedef struct {
+    _Atomic unsigned seq;            /* odd while a writer is inside */
+    pthread_mutex_t writer;          /* serializes writers only */
+} seqlock_t;
+
+#define SEQLOCK_INITIALIZER { 0, PTHREAD_MUTEX_INITIALIZER }
+
+/* Returns an even sequence number to pass to seqlock_read_retry() */
+static inline unsigned seqlock_read_begin(seqlock_t *sl) {
+    unsigned seq;
+    while ((seq = atomic_load_explicit(&sl->seq, memory_order_acquire)) & 1) {
+        sched_yield();               /* writer inside, let it finish */
+    }
+    return seq;
+}
+
+/* Returns non-zero if the data read since begin may be inconsistent */
+static inline int seqlock_read_retry(seqlock_t *sl, unsigned start) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&sl->seq, memory_order_relaxed) != start;
+}
+
+static inline void seqlock_write_lock(seqlock_t *sl) {
+    pthread_mutex_lock(&sl->writer);
+    unsigned seq = atomic_load_explicit(&sl->seq, memory_order_relaxed);
+    atomic_store_explicit(&sl->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void seqlock_write_unlock(seqlock_t *sl) {
+    unsigned seq = atomic_load_explicit(&sl->seq, memory_order_relaxed);
+    atomic_store_explicit(&sl->seq, seq + 1, memory_order_release);
+    pthread_mutex_unlock(&sl->writer);
+}
+
+/* ===== CONFIG CACHE ===== */
+
+/* Plain copy handed to callers */
+typedef struct {
+    int port;
+    int timeout_ms;
+    int max_connections;
+} config_t;
+
+/* Shared copy. Fields are atomics (accessed relaxed) because seqlock
+ * readers race with the writer by design - plain ints would be a C11
+ * data race. Relaxed loads compile to ordinary loads. */
+typedef struct {
+    _Atomic int port;
+    _Atomic int timeout_ms;
+    _Atomic int max_connections;
+} shared_config_t;
+
+/* Every version keeps: timeout_ms == port * 10, max_connections == port + 1
+ * so a reader can detect a torn (half-updated) config. */
+static int config_consistent(const config_t *c) {
+    return c->timeout_ms == c->port * 10 && c->max_connections == c->port + 1;
+}
+
+/* Mutex version */
+pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+config_t config_mutex = { 8080, 80800, 8081 };
+
+config_t read_config_mutex(void) {
+    pthread_mutex_lock(&mutex);
+    config_t c = config_mutex;
+    pthread_mutex_unlock(&mutex);
+    return c;
+}
+
+void write_config_mutex(int port) {
+    pthread_mutex_lock(&mutex);
+    config_mutex.port = port;
+    config_mutex.timeout_ms = port * 10;
+    config_mutex.max_connections = port + 1;
+    pthread_mutex_unlock(&mutex);
+}
+
+/* Rwlock version (02_config_cache.c) */
+pthread_rwlock_t rwlock = PTHREAD_RWLOCK_INITIALIZER;
+config_t config_rwlock = { 8080, 80800, 8081 };
+
+config_t read_config_rwlock(void) {
+    pthread_rwlock_rdlock(&rwlock);
+    config_t c = config_rwlock;
+    pthread_rwlock_unlock(&rwlock);
+    return c;
+}
+
+void write_config_rwlock(int port) {
+    pthread_rwlock_wrlock(&rwlock);
+    config_rwlock.port = port;
+    config_rwlock.timeout_ms = port * 10;
+    config_rwlock.max_connections = port + 1;
+    pthread_rwlock_unlock(&rwlock);
+}
+
+/* Seqlock version */
+seqlock_t config_lock = SEQLOCK_INITIALIZER;
+shared_config_t config_seq = { 8080, 80800, 8081 };
+
+config_t read_config_seqlock(void) {
+    config_t c;
+    unsigned seq;
+    do {
+        seq = seqlock_read_begin(&config_lock);
+        c.port = atomic_load_explicit(&config_seq.port, memory_order_relaxed);
+        c.timeout_ms = atomic_load_explicit(&config_seq.timeout_ms, memory_order_relaxed);
+        c.max_connections = atomic_load_explicit(&config_seq.max_connections, memory_order_relaxed);
+    } while (seqlock_read_retry(&config_lock, seq));
+    return c;
+}
+
+void write_config_seqlock(int port) {
+    seqlock_write_lock(&config_lock);
+    atomic_store_explicit(&config_seq.port, port, memory_order_relaxed);
+    atomic_store_explicit(&config_seq.timeout_ms, port * 10, memory_order_relaxed);
+    atomic_store_explicit(&config_seq.max_connections, port + 1, memory_order_relaxed);
+    seqlock_write_unlock(&config_lock);
+}
+
+/* ===== BENCHMARK HARNESS ===== */
+
+typedef struct {
+    const char *name;
+    config_t (*read)(void);
+    void (*write)(int port);
+} contender_t;
+
+atomic_long torn_reads;
+
+void* reader(void* arg) {
+    const contender_t *c = arg;
+    long torn = 0;
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        config_t cfg = c->read();
+        if (!config_consistent(&cfg)) {
+            torn++;
+        }
+    }
+    atomic_fetch_add(&torn_reads, torn);
+    return NULL;
+}
+
+void* writer(void* arg) {
+    const contender_t *c = arg;
+
+    for (int i = 0; i < ITERATIONS / WRITE_EVERY; i++) {
+        c->write(8080 + i);
+        sched_yield();               /* updates are rare: spread them out */
+    }
+    return NULL;
+}
+
+double benchmark(const contender_t *c) {
+    pthread_t readers[NUM_READERS];
+    pthread_t writers[NUM_WRITERS];
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < NUM_READERS; i++) {
+        pthread_create(&readers[i], NULL, reader, (void *)c);
+    }
+    for (int i = 0; i < NUM_WRITERS; i++) {
+        pthread_create(&writers[i], NULL, writer, (void *)c);
+    }
+
+    for (int i = 0; i < NUM_READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+    for (int i = 0; i < NUM_WRITERS; i++) {
+        pthread_join(writers[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start.tv_sec) +
+           (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+int main(void) {
+    const contender_t contenders[] = {
+        { "Mutex",   read_config_mutex,   write_config_mutex },
+        { "Rwlock",  read_config_rwlock,  write_config_rwlock },
+        { "Seqlock", read_config_seqlock, write_config_seqlock },
+    };
+    const int n = sizeof(contenders) / sizeof(contenders[0]);
+    double times[3];
+    long torn[3];
+
+    printf("=== Config Cache: Mutex vs Rwlock vs Seqlock ===\n\n");
+    printf("Workload: %d readers, %d writer\n", NUM_READERS, NUM_WRITERS);
+    printf("Each reader: %d config reads\n", ITERATIONS);
+    printf("Writer: %d updates (1 per %d reads per reader)\n\n",
+           ITERATIONS / WRITE_EVERY, WRITE_EVERY);
+
+    for (int i = 0; i < n; i++) {
+        atomic_store(&torn_reads, 0);
+        times[i] = benchmark(&contenders[i]);
+        torn[i] = atomic_load(&torn_reads);
+        printf("%-8s %.3f seconds  (%.1f M reads/s, %ld torn reads)\n",
+               contenders[i].name, times[i],
+               (double)NUM_READERS * ITERATIONS / times[i] / 1e6, torn[i]);
+    }
+
+    printf("\n=== Results ===\n");
+    printf("Seqlock vs mutex:  %.2fx\n", times[0] / times[2]);
+    printf("Seqlock vs rwlock: %.2fx\n", times[1] / times[2]);
+    if (torn[0] + torn[1] + torn[2] == 0) {
+        printf("✅ No reader saw a half-updated config\n");
+    } else {
+        printf("❌ Torn reads detected!\n");
+    }
+
+    printf("\n=== Why Seqlock Wins ===\n");
+    printf("Mutex:   lock + unlock = 2 atomic writes per read, 1 reader at a time\n");
+    printf("Rwlock:  rdlock + unlock = 2 atomic writes to the SAME shared word\n");
+    printf("Seqlock: 2 plain loads of seq - readers never write shared memory\n");
+
+    printf("\n=== When to Use a Seqlock ===\n");
+    printf("✅ Small struct, cheap to copy (a few words)\n");
+    printf("✅ Very read-heavy, writes are rare\n");
+    printf("✅ Data has no pointers (a retry may see a half-written one)\n");
+    printf("❌ Not for big structs or frequent writes - readers keep retrying\n");
+
+    return 0;
+}
+
+/*
+ * NOTES:
+ *
+ * 1. Why the retry is safe
+ *    - The reader may copy a half-updated config, but then seq is
+ *      odd or has changed, so the copy is thrown away.
+ *    - Never act on the data INSIDE the loop (no pointer derefs,
+ *      no divisions by a field) - only after the retry check passes.
+ *
+ * 2. Memory ordering
+ *    - Writer: seq odd -> release fence -> data -> seq even (release)
+ *    - Reader: seq (acquire) -> data -> acquire fence -> seq again
+ *    - This is the pattern from Boehm, "Can Seqlocks Get Along with
+ *      Programming Language Memory Models?" (MSPC 2012).
+ *
+ * 3. Where it is used
+ *    - Linux kernel: jiffies / xtime (timekeeping), seqlock_t
+ *    - vDSO clock_gettime(): user space reads kernel time with a seqcount
+ *
+ * 4. Bigger or pointer-based config?
+ *    - Publish an immutable copy through an atomic pointer instead
+ *      (RCU) - see system_design/01_layered_architecture/10_config_rcu.c
+ */
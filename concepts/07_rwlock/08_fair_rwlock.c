@@ -0,0 +1,418 @@
+/**
+ * 08_fair_rwlock.c - Writer-Preferring and Phase-Fair Rwlocks
+ *
+ * 03_writer_starvation.c shows a writer blocked while readers keep
+ * overlapping. This file fixes it with two lock policies and measures
+ * the cost:
+ *
+ *   READER-PREFERRING (baseline, glibc's default behaviour)
+ *     A reader gets in whenever no writer HOLDS the lock.
+ *     -> overlapping readers can starve a writer forever.
+ *
+ *   WRITER-PREFERRING
+ *     A reader waits while a writer holds OR is waiting.
+ *     -> writers get in quickly, but a stream of writers can
+ *        starve readers instead.
+ *
+ *   PHASE-FAIR (Brandenburg & Anderson, 2009)
+ *     Reader and writer phases alternate. A waiting writer blocks
+ *     NEW readers; when a writer releases, every reader that queued
+ *     behind it is admitted as one batch before the next writer.
+ *     -> a writer waits at most one reader phase, a reader waits at
+ *        most one writer phase.
+ *
+ * Harness: readers that hold the lock with overlap (like 03), plus
+ * writers pushing config updates every 5 ms. Reports writer wait
+ * percentiles, reader wait percentiles and reader throughput.
+ *
+ * Compile: gcc -Wall -Wextra -pthread -std=c11 -D_XOPEN_SOURCE=700 08_fair_rwlock.c -o 08_fair_rwlock
+ * Run: ./08_fair_rwlock
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+#define NUM_READERS 6
+#define NUM_WRITERS 2
+#define RUN_MS 1000
+#define READ_HOLD_US 200             /* reader critical section */
+#define READ_GAP_US 50               /* short gap -> readers overlap */
+#define WRITE_HOLD_US 100
+#define WRITE_PERIOD_US 5000         /* one config push per 5 ms */
+#define MAX_SAMPLES 200000
+
+/* ===== LOCK ===== */
+
+typedef enum {
+    PREFER_READER,
+    PREFER_WRITER,
+    PHASE_FAIR,
+    NUM_POLICIES
+} rw_policy_t;
+
+static const char *policy_names[NUM_POLICIES] = {
+    "reader-preferring",
+    "writer-preferring",
+    "phase-fair",
+};
+
+typedef struct {
+    pthread_mutex_t m;
+    pthread_cond_t readers_cv;
+    pthread_cond_t writers_cv;
+    rw_policy_t policy;
+    int readers;                     /* readers holding the lock */
+    int writer;                      /* 1 if a writer holds the lock */
+    int writers_waiting;
+    int readers_waiting;             /* phase-fair: queued behind a writer */
+    unsigned long phase;             /* phase-fair: bumped per writer release */
+} rwlock_t;
+
+void rw_init(rwlock_t *rw, rw_policy_t policy) {
+    pthread_mutex_init(&rw->m, NULL);
+    pthread_cond_init(&rw->readers_cv, NULL);
+    pthread_cond_init(&rw->writers_cv, NULL);
+    rw->policy = policy;
+    rw->readers = 0;
+    rw->writer = 0;
+    rw->writers_waiting = 0;
+    rw->readers_waiting = 0;
+    rw->phase = 0;
+}
+
+void rw_destroy(rwlock_t *rw) {
+    pthread_cond_destroy(&rw->writers_cv);
+    pthread_cond_destroy(&rw->readers_cv);
+    pthread_mutex_destroy(&rw->m);
+}
+
+void rw_rdlock(rwlock_t *rw) {
+    pthread_mutex_lock(&rw->m);
+
+    switch (rw->policy) {
+    case PREFER_READER:
+        while (rw->writer) {
+            pthread_cond_wait(&rw->readers_cv, &rw->m);
+        }
+        rw->readers++;
+        break;
+
+    case PREFER_WRITER:
+        while (rw->writer || rw->writers_waiting) {
+            pthread_cond_wait(&rw->readers_cv, &rw->m);
+        }
+        rw->readers++;
+        break;
+
+    case PHASE_FAIR:
+        if (!rw->writer && !rw->writers_waiting) {
+            rw->readers++;
+        } else {
+            /* Queue for the next reader phase. The releasing writer
+             * counts us in before waking us, so no writer can slip in. */
+            unsigned long my_phase = rw->phase;
+            rw->readers_waiting++;
+            while (rw->phase == my_phase) {
+                pthread_cond_wait(&rw->readers_cv, &rw->m);
+            }
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    pthread_mutex_unlock(&rw->m);
+}
+
+void rw_rdunlock(rwlock_t *rw) {
+    pthread_mutex_lock(&rw->m);
+    rw->readers--;
+    if (rw->readers == 0 && rw->writers_waiting) {
+        pthread_cond_signal(&rw->writers_cv);
+    }
+    pthread_mutex_unlock(&rw->m);
+}
+
+void rw_wrlock(rwlock_t *rw) {
+    pthread_mutex_lock(&rw->m);
+    rw->writers_waiting++;
+    while (rw->writer || rw->readers) {
+        pthread_cond_wait(&rw->writers_cv, &rw->m);
+    }
+    rw->writers_waiting--;
+    rw->writer = 1;
+    pthread_mutex_unlock(&rw->m);
+}
+
+void rw_wrunlock(rwlock_t *rw) {
+    pthread_mutex_lock(&rw->m);
+    rw->writer = 0;
+
+    switch (rw->policy) {
+    case PREFER_READER:
+        pthread_cond_broadcast(&rw->readers_cv);
+        pthread_cond_signal(&rw->writers_cv);
+        break;
+
+    case PREFER_WRITER:
+        if (rw->writers_waiting) {
+            pthread_cond_signal(&rw->writers_cv);
+        } else {
+            pthread_cond_broadcast(&rw->readers_cv);
+        }
+        break;
+
+    case PHASE_FAIR:
+        if (rw->readers_waiting) {
+            /* Hand the lock to the whole queued reader batch */
+            rw->readers += rw->readers_waiting;
+            rw->readers_waiting = 0;
+            rw->phase++;
+            pthread_cond_broadcast(&rw->readers_cv);
+        } else if (rw->writers_waiting) {
+            pthread_cond_signal(&rw->writers_cv);
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    pthread_mutex_unlock(&rw->m);
+}
+
+/* ===== HARNESS ===== */
+
+typedef struct {
+    double *us;
+    int count;
+} samples_t;
+
+static void sample_add(samples_t *s, double us) {
+    if (s->count < MAX_SAMPLES) {
+        s->us[s->count++] = us;
+    }
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(samples_t *s, double p) {
+    if (s->count == 0) {
+        return 0.0;
+    }
+    int idx = (int)(p / 100.0 * (s->count - 1) + 0.5);
+    return s->us[idx];
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void sleep_us(long us) {
+    struct timespec ts = { us / 1000000, (us % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+rwlock_t lock;
+atomic_bool stop;
+int shared_data = 0;
+
+pthread_mutex_t samples_lock = PTHREAD_MUTEX_INITIALIZER;
+samples_t writer_waits;
+samples_t reader_waits;
+long total_reads;
+
+void* reader_thread(void* arg) {
+    (void)arg;
+    long reads = 0;
+
+    while (!atomic_load(&stop)) {
+        double t0 = now_us();
+        rw_rdlock(&lock);
+        double waited = now_us() - t0;
+
+        volatile int value = shared_data;
+        (void)value;
+        sleep_us(READ_HOLD_US);      /* like 03: reader holds a while */
+        rw_rdunlock(&lock);
+        reads++;
+
+        pthread_mutex_lock(&samples_lock);
+        sample_add(&reader_waits, waited);
+        pthread_mutex_unlock(&samples_lock);
+
+        sleep_us(READ_GAP_US);
+    }
+
+    pthread_mutex_lock(&samples_lock);
+    total_reads += reads;
+    pthread_mutex_unlock(&samples_lock);
+    return NULL;
+}
+
+void* writer_thread(void* arg) {
+    (void)arg;
+
+    while (!atomic_load(&stop)) {
+        sleep_us(WRITE_PERIOD_US);
+
+        double t0 = now_us();
+        rw_wrlock(&lock);
+        double waited = now_us() - t0;
+
+        shared_data++;               /* config push */
+        sleep_us(WRITE_HOLD_US);
+        rw_wrunlock(&lock);
+
+        pthread_mutex_lock(&samples_lock);
+        sample_add(&writer_waits, waited);
+        pthread_mutex_unlock(&samples_lock);
+    }
+    return NULL;
+}
+
+typedef struct {
+    double reads_per_sec;
+    int writes;
+    double w_p50, w_p99, w_max;
+    double r_p50, r_p99, r_max;
+} result_t;
+
+result_t run(rw_policy_t policy) {
+    pthread_t readers[NUM_READERS];
+    pthread_t writers[NUM_WRITERS];
+    result_t r;
+
+    rw_init(&lock, policy);
+    atomic_store(&stop, false);
+    writer_waits.count = 0;
+    reader_waits.count = 0;
+    total_reads = 0;
+
+    double start = now_us();
+    for (int i = 0; i < NUM_READERS; i++) {
+        pthread_create(&readers[i], NULL, reader_thread, NULL);
+    }
+    for (int i = 0; i < NUM_WRITERS; i++) {
+        pthread_create(&writers[i], NULL, writer_thread, NULL);
+    }
+
+    sleep_us(RUN_MS * 1000L);
+    atomic_store(&stop, true);
+
+    /* Readers stop first, which also releases any starved writer */
+    for (int i = 0; i < NUM_READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+    double elapsed = (now_us() - start) / 1e6;
+    for (int i = 0; i < NUM_WRITERS; i++) {
+        pthread_join(writers[i], NULL);
+    }
+
+    qsort(writer_waits.us, writer_waits.count, sizeof(double), cmp_double);
+    qsort(reader_waits.us, reader_waits.count, sizeof(double), cmp_double);
+
+    r.reads_per_sec = total_reads / elapsed;
+    r.writes = writer_waits.count;
+    r.w_p50 = percentile(&writer_waits, 50);
+    r.w_p99 = percentile(&writer_waits, 99);
+    r.w_max = percentile(&writer_waits, 100);
+    r.r_p50 = percentile(&reader_waits, 50);
+    r.r_p99 = percentile(&reader_waits, 99);
+    r.r_max = percentile(&reader_waits, 100);
+
+    rw_destroy(&lock);
+    return r;
+}
+
+int main(void) {
+    result_t results[NUM_POLICIES];
+
+    writer_waits.us = malloc(MAX_SAMPLES * sizeof(double));
+    reader_waits.us = malloc(MAX_SAMPLES * sizeof(double));
+    if (!writer_waits.us || !reader_waits.us) {
+        perror("malloc");
+        return 1;
+    }
+
+    printf("=== Fixing Writer Starvation: Lock Policies ===\n\n");
+    printf("%d readers: hold %d us, gap %d us (always overlapping)\n",
+           NUM_READERS, READ_HOLD_US, READ_GAP_US);
+    printf("%d writers: push every %d us, hold %d us\n",
+           NUM_WRITERS, WRITE_PERIOD_US, WRITE_HOLD_US);
+    printf("Each policy runs %d ms\n\n", RUN_MS);
+
+    for (int p = 0; p < NUM_POLICIES; p++) {
+        results[p] = run((rw_policy_t)p);
+    }
+
+    printf("%-18s | %9s | %6s | %25s | %25s\n", "", "reads/s", "writes",
+           "writer wait us p50/p99/max", "reader wait us p50/p99/max");
+    printf("-------------------+-----------+--------+---------------------------+---------------------------\n");
+    for (int p = 0; p < NUM_POLICIES; p++) {
+        result_t *r = &results[p];
+        printf("%-18s | %9.0f | %6d | %7.0f / %7.0f / %7.0f | %7.0f / %7.0f / %7.0f\n",
+               policy_names[p], r->reads_per_sec, r->writes,
+               r->w_p50, r->w_p99, r->w_max,
+               r->r_p50, r->r_p99, r->r_max);
+    }
+
+    result_t *rp = &results[PREFER_READER];
+    result_t *wp = &results[PREFER_WRITER];
+    result_t *pf = &results[PHASE_FAIR];
+
+    printf("\n=== Results ===\n");
+    printf("Reader-preferring: %d writes in %d ms, worst writer wait %.0f ms\n",
+           rp->writes, RUN_MS, rp->w_max / 1000);
+    printf("Writer-preferring: writer p99 %.0f us, reads/s %.0f%% of baseline\n",
+           wp->w_p99, 100.0 * wp->reads_per_sec / rp->reads_per_sec);
+    printf("Phase-fair:        writer p99 %.0f us, reads/s %.0f%% of baseline\n",
+           pf->w_p99, 100.0 * pf->reads_per_sec / rp->reads_per_sec);
+
+    printf("\n=== Which to Pick ===\n");
+    printf("✅ Writer-preferring: bounded writer latency, simplest fix\n");
+    printf("   ...but a burst of writers stalls every reader\n");
+    printf("✅ Phase-fair: bounds BOTH sides - writer waits 1 reader phase,\n");
+    printf("   reader waits 1 writer phase. Best for config pushes.\n");
+    printf("❌ Reader-preferring: highest read rate, unbounded writer wait\n");
+
+    free(writer_waits.us);
+    free(reader_waits.us);
+    return 0;
+}
+
+/*
+ * PHASE-FAIR TIMELINE:
+ *
+ * Time | R1      | R2      | W1        | R3        | Phase
+ * -----|---------|---------|-----------|-----------|-----------------
+ * t0   | reading | reading |           |           | read
+ * t1   | reading | reading | wrlock    |           | W1 waiting
+ * t2   | reading | unlock  | waiting   | rdlock    | R3 queued (new
+ * t3   | unlock  |         | GOT LOCK  | waiting   |   readers blocked)
+ * t4   |         |         | unlock    | admitted  | read (R3 batch)
+ * t5   |         |         |           | reading   | W2 waits for t5
+ *
+ * Compare with 03_writer_starvation.c: there R3 would join R1/R2 at
+ * t2 and the writer would keep waiting.
+ *
+ * NOTES:
+ * - glibc offers PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP via
+ *   pthread_rwlockattr_setkind_np() (a GNU extension) for the
+ *   writer-preferring behaviour; there is no phase-fair option.
+ * - These locks use a mutex + condvars so waiters sleep. Spinning
+ *   versions (ticket-based PF-T) suit short kernel critical sections.
+ * - Reference: B. Brandenburg, J. Anderson, "Reader-Writer
+ *   Synchronization for Shared-Memory Multiprocessor Real-Time
+ *   Systems", ECRTS 2009.
+ */
@@ -0,0 +1,654 @@
+/**
+ * 01_lock_bench.c - Configurable Lock Contention Benchmark
+ *
+ * 07_rwlock/01_mutex_vs_rwlock.c, 06_spinlocks/03_test_and_test_and_set.c
+ * and the atomic counter demos each hand-roll their own threads, timing
+ * and hard-coded NUM_THREADS/ITERATIONS, so their numbers can't be
+ * compared. This program runs EVERY lock under identical conditions:
+ *
+ *   - Same worker loop, same critical-section work, same op mix
+ *   - Thread count, critical-section length, think time, read/write
+ *     ratio, pinning and duration come from the command line
+ *   - Each op's lock-acquire latency goes into a log-linear histogram
+ *   - One CSV row per lock: ops/s + latency percentiles
+ *
+ * Locks: mutex, rwlock, tas, ttas, ticket, semaphore, mcs
+ * Adding a lock = write lock/unlock functions + one lock_table[] entry.
+ *
+ * Compile: gcc -Wall -Wextra -pthread -std=c11 -D_GNU_SOURCE 01_lock_bench.c -o 01_lock_bench
+ * Run: ./01_lock_bench                       (all locks, defaults)
+ *      ./01_lock_bench -t 8 -c 200 -r 90 -p   (8 threads, 200 ns CS, 90% reads, pinned)
+ *      ./01_lock_bench -l ticket,mcs -H >> results.csv
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_THREADS 256
+#define SPIN_LIMIT 128               /* spins before yielding the CPU */
+
+/* Histogram: 8 linear sub-buckets per power of two (<= 12.5% error) */
+#define HIST_SUB_BITS 3
+#define HIST_SUB (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS (HIST_SUB + (64 - HIST_SUB_BITS) * HIST_SUB)
+
+/* ===== CONFIGURATION ===== */
+
+typedef struct {
+    int threads;
+    long cs_ns;                      /* work inside the lock */
+    long think_ns;                   /* work outside the lock */
+    int read_pct;                    /* % of ops that are reads */
+    bool pin;                        /* pin thread i to CPU i % ncpu */
+    int duration_ms;
+    bool header;                     /* print CSV header */
+    const char *locks;               /* "all" or comma-separated names */
+} bench_config_t;
+
+static bench_config_t config = {
+    .threads = 4,
+    .cs_ns = 100,
+    .think_ns = 0,
+    .read_pct = 90,
+    .pin = false,
+    .duration_ms = 500,
+    .header = true,
+    .locks = "all",
+};
+
+/* ===== TIMING ===== */
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static double loops_per_ns;
+
+static inline void busy_loops(uint64_t loops) {
+    volatile uint64_t sink = 0;
+    for (uint64_t i = 0; i < loops; i++) {
+        sink++;
+    }
+}
+
+/* Measure how many busy_loops() iterations fit in one nanosecond */
+static void calibrate(void) {
+    const uint64_t loops = 20000000;
+    uint64_t best = UINT64_MAX;
+
+    for (int i = 0; i < 3; i++) {
+        uint64_t t0 = now_ns();
+        busy_loops(loops);
+        uint64_t dt = now_ns() - t0;
+        if (dt < best) {
+            best = dt;
+        }
+    }
+    loops_per_ns = (double)loops / best;
+}
+
+static inline void spin_pause(int *spins) {
+    if (++*spins >= SPIN_LIMIT) {
+        sched_yield();               /* holder may be preempted */
+        *spins = 0;
+    }
+}
+
+/* ===== LATENCY HISTOGRAM ===== */
+
+typedef struct {
+    uint64_t count[HIST_BUCKETS];
+    uint64_t total;
+    uint64_t max;
+} histogram_t;
+
+static inline int hist_index(uint64_t v) {
+    if (v < HIST_SUB) {
+        return (int)v;
+    }
+    int msb = 63 - __builtin_clzll(v);
+    int shift = msb - HIST_SUB_BITS;
+    return HIST_SUB + shift * HIST_SUB + (int)((v >> shift) & (HIST_SUB - 1));
+}
+
+/* Largest value that lands in bucket idx */
+static uint64_t hist_upper(int idx) {
+    if (idx < HIST_SUB) {
+        return (uint64_t)idx;
+    }
+    int shift = (idx - HIST_SUB) / HIST_SUB;
+    uint64_t sub = (uint64_t)((idx - HIST_SUB) % HIST_SUB);
+    uint64_t lower = (HIST_SUB + sub) << shift;
+    return lower + (1ull << shift) - 1;
+}
+
+static inline void hist_record(histogram_t *h, uint64_t v) {
+    h->count[hist_index(v)]++;
+    h->total++;
+    if (v > h->max) {
+        h->max = v;
+    }
+}
+
+static void hist_merge(histogram_t *dst, const histogram_t *src) {
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        dst->count[i] += src->count[i];
+    }
+    dst->total += src->total;
+    if (src->max > dst->max) {
+        dst->max = src->max;
+    }
+}
+
+static uint64_t hist_percentile(const histogram_t *h, double p) {
+    if (h->total == 0) {
+        return 0;
+    }
+    uint64_t target = (uint64_t)(p / 100.0 * h->total + 0.5);
+    if (target == 0) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->count[i];
+        if (seen >= target) {
+            uint64_t upper = hist_upper(i);
+            return upper < h->max ? upper : h->max;
+        }
+    }
+    return h->max;
+}
+
+/* ===== WORKER STATE ===== */
+
+typedef struct mcs_node {
+    _Atomic(struct mcs_node *) next;
+    atomic_bool locked;
+} mcs_node_t;
+
+typedef struct {
+    _Alignas(64) int id;
+    uint64_t rng;
+    uint64_t ops;
+    uint64_t writes;
+    mcs_node_t mcs;                  /* this thread's MCS queue node */
+    histogram_t hist;
+} worker_t;
+
+/* ===== LOCKS ===== */
+
+typedef struct {
+    const char *name;
+    void (*init)(void);
+    void (*destroy)(void);
+    void (*lock)(worker_t *w, bool write);
+    void (*unlock)(worker_t *w, bool write);
+} lock_ops_t;
+
+/* Mutex */
+static pthread_mutex_t mutex_lock_obj;
+
+static void mutex_init(void) { pthread_mutex_init(&mutex_lock_obj, NULL); }
+static void mutex_destroy(void) { pthread_mutex_destroy(&mutex_lock_obj); }
+
+static void mutex_acquire(worker_t *w, bool write) {
+    (void)w; (void)write;
+    pthread_mutex_lock(&mutex_lock_obj);
+}
+
+static void mutex_release(worker_t *w, bool write) {
+    (void)w; (void)write;
+    pthread_mutex_unlock(&mutex_lock_obj);
+}
+
+/* Rwlock: the only lock here that lets reads run in parallel */
+static pthread_rwlock_t rwlock_obj;
+
+static void rwlock_init(void) { pthread_rwlock_init(&rwlock_obj, NULL); }
+static void rwlock_destroy(void) { pthread_rwlock_destroy(&rwlock_obj); }
+
+static void rwlock_acquire(worker_t *w, bool write) {
+    (void)w;
+    if (write) {
+        pthread_rwlock_wrlock(&rwlock_obj);
+    } else {
+        pthread_rwlock_rdlock(&rwlock_obj);
+    }
+}
+
+static void rwlock_release(worker_t *w, bool write) {
+    (void)w; (void)write;
+    pthread_rwlock_unlock(&rwlock_obj);
+}
+
+/* Test-and-set (06_spinlocks/03) */
+static atomic_int tas_obj;
+
+static void tas_init(void) { atomic_store(&tas_obj, 0); }
+static void tas_destroy(void) { }
+
+static void tas_acquire(worker_t *w, bool write) {
+    (void)w; (void)write;
+    int spins = 0;
+    while (atomic_exchange_explicit(&tas_obj, 1, memory_order_acquire)) {
+        spin_pause(&spins);
+    }
+}
+
+static void tas_release(worker_t *w, bool write) {
+    (void)w; (void)write;
+    atomic_store_explicit(&tas_obj, 0, memory_order_release);
+}
+
+/* Test-and-test-and-set (06_spinlocks/03) - shares tas_obj's release */
+static void ttas_acquire(worker_t *w, bool write) {
+    (void)w; (void)write;
+    int spins = 0;
+    for (;;) {
+        while (atomic_load_explicit(&tas_obj, memory_order_relaxed)) {
+            spin_pause(&spins);
+        }
+        if (!atomic_exchange_explicit(&tas_obj, 1, memory_order_acquire)) {
+            break;
+        }
+    }
+}
+
+/* Ticket (06_spinlocks/04) */
+static struct {
+    atomic_uint next_ticket;
+    atomic_uint now_serving;
+} ticket_obj;
+
+static void ticket_init(void) {
+    atomic_store(&ticket_obj.next_ticket, 0);
+    atomic_store(&ticket_obj.now_serving, 0);
+}
+static void ticket_destroy(void) { }
+
+static void ticket_acquire(worker_t *w, bool write) {
+    (void)w; (void)write;
+    int spins = 0;
+    unsigned my_ticket = atomic_fetch_add_explicit(&ticket_obj.next_ticket, 1,
+                                                   memory_order_relaxed);
+    while (atomic_load_explicit(&ticket_obj.now_serving, memory_order_acquire) != my_ticket) {
+        spin_pause(&spins);
+    }
+}
+
+static void ticket_release(worker_t *w, bool write) {
+    (void)w; (void)write;
+    atomic_fetch_add_explicit(&ticket_obj.now_serving, 1, memory_order_release);
+}
+
+/* Binary semaphore (04_semaphores/01) */
+static sem_t sem_obj;
+
+static void sem_lock_init(void) { sem_init(&sem_obj, 0, 1); }
+static void sem_lock_destroy(void) { sem_destroy(&sem_obj); }
+
+static void sem_acquire(worker_t *w, bool write) {
+    (void)w; (void)write;
+    while (sem_wait(&sem_obj) != 0) {
+        /* EINTR: retry */
+    }
+}
+
+static void sem_release(worker_t *w, bool write) {
+    (void)w; (void)write;
+    sem_post(&sem_obj);
+}
+
+/* MCS queue lock: FIFO like ticket, but each waiter spins on its
+ * OWN node instead of one shared now_serving word. */
+static _Atomic(mcs_node_t *) mcs_tail;
+
+static void mcs_init(void) { atomic_store(&mcs_tail, NULL); }
+static void mcs_destroy(void) { }
+
+static void mcs_acquire(worker_t *w, bool write) {
+    (void)write;
+    mcs_node_t *node = &w->mcs;
+    int spins = 0;
+
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    atomic_store_explicit(&node->locked, true, memory_order_relaxed);
+
+    mcs_node_t *prev = atomic_exchange_explicit(&mcs_tail, node, memory_order_acq_rel);
+    if (prev) {
+        atomic_store_explicit(&prev->next, node, memory_order_release);
+        while (atomic_load_explicit(&node->locked, memory_order_acquire)) {
+            spin_pause(&spins);
+        }
+    }
+}
+
+static void mcs_release(worker_t *w, bool write) {
+    (void)write;
+    mcs_node_t *node = &w->mcs;
+    int spins = 0;
+    mcs_node_t *next = atomic_load_explicit(&node->next, memory_order_acquire);
+
+    if (!next) {
+        mcs_node_t *expected = node;
+        if (atomic_compare_exchange_strong_explicit(&mcs_tail, &expected, NULL,
+                memory_order_release, memory_order_relaxed)) {
+            return;                  /* no one waiting */
+        }
+        /* A successor swapped the tail but hasn't linked in yet */
+        while (!(next = atomic_load_explicit(&node->next, memory_order_acquire))) {
+            spin_pause(&spins);
+        }
+    }
+    atomic_store_explicit(&next->locked, false, memory_order_release);
+}
+
+static const lock_ops_t lock_table[] = {
+    { "mutex",     mutex_init,    mutex_destroy,    mutex_acquire,  mutex_release },
+    { "rwlock",    rwlock_init,   rwlock_destroy,   rwlock_acquire, rwlock_release },
+    { "tas",       tas_init,      tas_destroy,      tas_acquire,    tas_release },
+    { "ttas",      tas_init,      tas_destroy,      ttas_acquire,   tas_release },
+    { "ticket",    ticket_init,   ticket_destroy,   ticket_acquire, ticket_release },
+    { "semaphore", sem_lock_init, sem_lock_destroy, sem_acquire,    sem_release },
+    { "mcs",       mcs_init,      mcs_destroy,      mcs_acquire,    mcs_release },
+};
+
+#define NUM_LOCKS ((int)(sizeof(lock_table) / sizeof(lock_table[0])))
+
+/* ===== BENCHMARK ===== */
+
+static const lock_ops_t *current;
+static pthread_barrier_t start_barrier;
+static atomic_bool stop;
+static uint64_t shared_counter;      /* written only under the lock */
+static uint64_t cs_loops, think_loops;
+
+static inline uint64_t xorshift64(uint64_t *s) {
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *s = x;
+}
+
+static void pin_to_cpu(int id) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(id % (ncpu > 0 ? ncpu : 1), &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        fprintf(stderr, "warning: could not pin thread %d\n", id);
+    }
+}
+
+static void* worker_thread(void* arg) {
+    worker_t *w = arg;
+    const lock_ops_t *ops = current;
+
+    if (config.pin) {
+        pin_to_cpu(w->id);
+    }
+    pthread_barrier_wait(&start_barrier);
+
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        bool write = (int)(xorshift64(&w->rng) % 100) >= config.read_pct;
+
+        uint64_t t0 = now_ns();
+        ops->lock(w, write);
+        uint64_t t1 = now_ns();
+
+        if (write) {
+            shared_counter++;
+            w->writes++;
+        } else {
+            volatile uint64_t value = shared_counter;
+            (void)value;
+        }
+        busy_loops(cs_loops);
+
+        ops->unlock(w, write);
+
+        hist_record(&w->hist, t1 - t0);
+        w->ops++;
+        busy_loops(think_loops);
+    }
+    return NULL;
+}
+
+static int run_lock(const lock_ops_t *ops, worker_t *workers) {
+    pthread_t threads[MAX_THREADS];
+    struct timespec run = {
+        .tv_sec = config.duration_ms / 1000,
+        .tv_nsec = (config.duration_ms % 1000) * 1000000L,
+    };
+
+    current = ops;
+    shared_counter = 0;
+    atomic_store(&stop, false);
+    ops->init();
+    pthread_barrier_init(&start_barrier, NULL, config.threads + 1);
+
+    for (int i = 0; i < config.threads; i++) {
+        memset(&workers[i], 0, sizeof(workers[i]));
+        workers[i].id = i;
+        workers[i].rng = 0x9E3779B97F4A7C15ull * (i + 1);
+        pthread_create(&threads[i], NULL, worker_thread, &workers[i]);
+    }
+
+    pthread_barrier_wait(&start_barrier);
+    uint64_t start = now_ns();
+    nanosleep(&run, NULL);
+    atomic_store(&stop, true);
+    for (int i = 0; i < config.threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double secs = (now_ns() - start) / 1e9;
+
+    static histogram_t total;
+    memset(&total, 0, sizeof(total));
+    uint64_t writes = 0;
+    for (int i = 0; i < config.threads; i++) {
+        hist_merge(&total, &workers[i].hist);
+        writes += workers[i].writes;
+    }
+
+    /* Every write incremented shared_counter under the lock */
+    bool ok = shared_counter == writes;
+
+    printf("%s,%d,%ld,%ld,%d,%d,%.3f,%llu,%.0f,%llu,%llu,%llu,%llu,%llu,%s\n",
+           ops->name, config.threads, config.cs_ns, config.think_ns,
+           config.read_pct, config.pin ? 1 : 0, secs,
+           (unsigned long long)total.total, total.total / secs,
+           (unsigned long long)hist_percentile(&total, 50),
+           (unsigned long long)hist_percentile(&total, 90),
+           (unsigned long long)hist_percentile(&total, 99),
+           (unsigned long long)hist_percentile(&total, 99.9),
+           (unsigned long long)total.max,
+           ok ? "ok" : "FAIL");
+    fflush(stdout);
+
+    pthread_barrier_destroy(&start_barrier);
+    ops->destroy();
+    return ok ? 0 : 1;
+}
+
+/* ===== COMMAND LINE ===== */
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -t N     threads (1..%d, default %d)\n"
+        "  -c NS    critical-section length in ns (default %ld)\n"
+        "  -n NS    think time outside the lock in ns (default %ld)\n"
+        "  -r PCT   read percentage 0..100 (default %d)\n"
+        "  -p       pin thread i to CPU i %% ncpu\n"
+        "  -d MS    duration per lock in ms (default %d)\n"
+        "  -l LIST  comma-separated locks or 'all' (default all)\n"
+        "  -H       omit the CSV header (for appending runs)\n"
+        "Locks:",
+        prog, MAX_THREADS, config.threads, config.cs_ns, config.think_ns,
+        config.read_pct, config.duration_ms);
+    for (int i = 0; i < NUM_LOCKS; i++) {
+        fprintf(stderr, " %s", lock_table[i].name);
+    }
+    fprintf(stderr, "\n");
+}
+
+static bool parse_long(const char *s, long min, long max, long *out) {
+    char *end;
+    long v = strtol(s, &end, 10);
+    if (*s == '\0' || *end != '\0' || v < min || v > max) {
+        return false;
+    }
+    *out = v;
+    return true;
+}
+
+static const lock_ops_t *find_lock(const char *name) {
+    for (int i = 0; i < NUM_LOCKS; i++) {
+        if (strcmp(lock_table[i].name, name) == 0) {
+            return &lock_table[i];
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    const lock_ops_t *selected[NUM_LOCKS];
+    int num_selected = 0;
+    int opt;
+    long v;
+
+    while ((opt = getopt(argc, argv, "t:c:n:r:pd:l:Hh")) != -1) {
+        switch (opt) {
+        case 't':
+            if (!parse_long(optarg, 1, MAX_THREADS, &v)) goto bad;
+            config.threads = (int)v;
+            break;
+        case 'c':
+            if (!parse_long(optarg, 0, 100000000, &v)) goto bad;
+            config.cs_ns = v;
+            break;
+        case 'n':
+            if (!parse_long(optarg, 0, 100000000, &v)) goto bad;
+            config.think_ns = v;
+            break;
+        case 'r':
+            if (!parse_long(optarg, 0, 100, &v)) goto bad;
+            config.read_pct = (int)v;
+            break;
+        case 'p':
+            config.pin = true;
+            break;
+        case 'd':
+            if (!parse_long(optarg, 1, 600000, &v)) goto bad;
+            config.duration_ms = (int)v;
+            break;
+        case 'l':
+            config.locks = optarg;
+            break;
+        case 'H':
+            config.header = false;
+            break;
+        case 'h':
+            usage(argv[0]);
+            return 0;
+        default:
+            goto bad;
+        }
+    }
+    if (optind != argc) {
+        goto bad;
+    }
+
+    if (strcmp(config.locks, "all") == 0) {
+        for (int i = 0; i < NUM_LOCKS; i++) {
+            selected[num_selected++] = &lock_table[i];
+        }
+    } else {
+        char list[256];
+        snprintf(list, sizeof(list), "%s", config.locks);
+        for (char *name = strtok(list, ","); name; name = strtok(NULL, ",")) {
+            const lock_ops_t *ops = find_lock(name);
+            if (!ops) {
+                fprintf(stderr, "unknown lock '%s'\n", name);
+                goto bad;
+            }
+            if (num_selected < NUM_LOCKS) {
+                selected[num_selected++] = ops;
+            }
+        }
+    }
+
+    worker_t *workers = aligned_alloc(64, sizeof(worker_t) * config.threads);
+    if (!workers) {
+        perror("aligned_alloc");
+        return 1;
+    }
+
+    calibrate();
+    cs_loops = (uint64_t)(config.cs_ns * loops_per_ns);
+    think_loops = (uint64_t)(config.think_ns * loops_per_ns);
+
+    /* Human-readable context on stderr so stdout stays pure CSV */
+    fprintf(stderr, "# %ld online CPUs, %.2f loops/ns, %d threads, cs %ld ns, "
+            "think %ld ns, %d%% reads%s\n",
+            sysconf(_SC_NPROCESSORS_ONLN), loops_per_ns, config.threads,
+            config.cs_ns, config.think_ns, config.read_pct,
+            config.pin ? ", pinned" : "");
+
+    if (config.header) {
+        printf("lock,threads,cs_ns,think_ns,read_pct,pinned,duration_s,ops,"
+               "ops_per_sec,acq_p50_ns,acq_p90_ns,acq_p99_ns,acq_p999_ns,"
+               "acq_max_ns,check\n");
+    }
+
+    int failures = 0;
+    for (int i = 0; i < num_selected; i++) {
+        failures += run_lock(selected[i], workers);
+    }
+
+    free(workers);
+    return failures ? 1 : 0;
+
+bad:
+    usage(argv[0]);
+    return 1;
+}
+
+/*
+ * READING THE CSV:
+ *
+ * ops_per_sec   Completed lock/unlock pairs per second (all threads).
+ * acq_*_ns      Time from calling lock() to owning it. Log-linear
+ *               buckets, so values are upper bounds within 12.5%.
+ *               Includes ~2 clock_gettime() calls of overhead.
+ * check         "ok" if every write was seen exactly once - a broken
+ *               lock shows up as FAIL here.
+ *
+ * IDENTICAL CONDITIONS:
+ * - All spinning locks share one policy: spin SPIN_LIMIT times, then
+ *   sched_yield(). Without it, a spinner on an oversubscribed CPU burns
+ *   its whole time slice while the holder is preempted.
+ * - Only rwlock treats reads differently; every other lock is
+ *   exclusive for both reads and writes.
+ *
+ * EXPERIMENTS TO TRY:
+ * - Thread sweep:  for t in 1 2 4 8 16; do ./01_lock_bench -t $t -H; done
+ * - Long CS:       -c 5000  (spinning wastes CPU, mutex catches up)
+ * - Read-heavy:    -r 99    (rwlock pulls ahead with long CS)
+ * - Fairness:      compare acq_p999_ns of tas vs ticket vs mcs
+ * - Pinning:       -p on a multi-core box (keeps cache lines local)
+ */
@@ -0,0 +1,421 @@
+/**
+ * 07_batched_adc.c - Multi-Channel Batched ADC Acquisition
+ *
+ * temp_sensor_read() in 04_production.c reads ONE channel per call:
+ * driver checks, a HAL call, the HAL's parameter checks, one conversion
+ * to float. Monitoring 64 channels means 64 trips down the stack per
+ * scan, and 64 float conversions on a part that may not have an FPU.
+ *
+ * This version adds a scan path through every layer:
+ * - HAL:    hal_adc_read_many(channels, out, n) - one call, channel list
+ *           validated in one pass, samples copied from the scan buffer
+ *           (what a DMA-driven ADC sequencer leaves in RAM)
+ * - Driver: temp_sensor_read_all() - ONE integer pass over the scan
+ *           snapshot (0.01 C units): converts, flags out-of-range
+ *           channels in a bitmask and counts channels over the alarm
+ *           threshold, so the samples are touched exactly once
+ * - App:    one call per scan instead of 64
+ *
+ * Compile: gcc -O2 -std=c11 07_batched_adc.c -o batched_adc
+ * Run:     ./batched_adc
+ *
+ * Study time: 20 minutes
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* ============================================================================
+ * ERROR CODES
+ * ============================================================================ */
+typedef enum {
+    STATUS_OK = 0,
+    STATUS_ERROR_INIT,
+    STATUS_ERROR_TIMEOUT,
+    STATUS_ERROR_INVALID_PARAM,
+    STATUS_ERROR_HARDWARE
+} status_t;
+
+/* ============================================================================
+ * LAYER 1: HAL
+ * ============================================================================ */
+
+/* 4 ADC units x 16 inputs, or one ADC behind an external mux */
+#define HAL_ADC_CHANNELS  64
+
+/*
+ * Simulated ADC result registers. A real sequencer converts the whole
+ * channel list and DMAs the results here; reading them is plain loads.
+ */
+static volatile uint16_t sim_adc_data[HAL_ADC_CHANNELS];
+
+status_t hal_adc_init(void) {
+    /* Initialize ADC, configure sequencer + DMA */
+    return STATUS_OK;
+}
+
+/*
+ * Single read, as in 04_production.c. noinline stands in for the HAL
+ * living in its own translation unit (no LTO), which is what the driver
+ * pays on every call.
+ */
+__attribute__((noinline))
+status_t hal_adc_read(uint8_t channel, uint16_t *value) {
+    if (value == NULL || channel >= HAL_ADC_CHANNELS) {
+        return STATUS_ERROR_INVALID_PARAM;
+    }
+
+    *value = sim_adc_data[channel];
+    return STATUS_OK;
+}
+
+/*
+ * Scan read: n samples for the n channels listed, in list order.
+ * Pointers and the channel list are checked once, then the volatile
+ * result registers are copied into out[] in one pass. Callers work on
+ * that plain-RAM snapshot, never on the volatile buffer.
+ */
+__attribute__((noinline))
+status_t hal_adc_read_many(const uint8_t *channels, uint16_t *out, size_t n) {
+    if (channels == NULL || out == NULL || n == 0 || n > HAL_ADC_CHANNELS) {
+        return STATUS_ERROR_INVALID_PARAM;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (channels[i] >= HAL_ADC_CHANNELS) {
+            return STATUS_ERROR_INVALID_PARAM;
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        out[i] = sim_adc_data[channels[i]];
+    }
+    return STATUS_OK;
+}
+
+/* ============================================================================
+ * LAYER 2: DRIVERS
+ * ============================================================================ */
+
+/*
+ * Conversion (sensor: 10 mV/C, 500 mV offset, 10-bit ADC, 5 V ref):
+ *   float:   T = (adc * 5.0 / 1024 - 0.5) * 100            [C]
+ *   integer: T = (adc * 50000 + 512) / 1024 - 5000          [0.01 C]
+ * adc * 50000 < 2^26, so int32 lanes never overflow. The integer result
+ * is within 0.01 C of the float one (they round halves differently).
+ */
+#define TEMP_SCALE            100        /* Units per degree C */
+#define TEMP_MIN_CENTI        (-40 * TEMP_SCALE)
+#define TEMP_MAX_CENTI        (125 * TEMP_SCALE)
+
+static inline int32_t adc_to_centi_celsius(uint16_t adc) {
+    return (((int32_t)adc * 50000 + 512) >> 10) - 5000;
+}
+
+/* Temperature Sensor Driver: single channel (04_production.c) */
+typedef struct {
+    bool initialized;
+    uint8_t channel;
+    float last_reading;
+} temp_sensor_t;
+
+static temp_sensor_t temp_sensor = {0};
+
+status_t temp_sensor_init(uint8_t channel) {
+    if (channel >= HAL_ADC_CHANNELS) {
+        return STATUS_ERROR_INVALID_PARAM;
+    }
+
+    status_t status = hal_adc_init();
+    if (status != STATUS_OK) {
+        return status;
+    }
+
+    temp_sensor.channel = channel;
+    temp_sensor.initialized = true;
+    temp_sensor.last_reading = 0.0f;
+    return STATUS_OK;
+}
+
+status_t temp_sensor_read(float *temperature) {
+    uint16_t adc_value;
+    status_t status;
+
+    if (!temp_sensor.initialized) {
+        return STATUS_ERROR_INIT;
+    }
+
+    if (temperature == NULL) {
+        return STATUS_ERROR_INVALID_PARAM;
+    }
+
+    status = hal_adc_read(temp_sensor.channel, &adc_value);
+    if (status != STATUS_OK) {
+        return status;
+    }
+
+    /* Convert with bounds checking */
+    float voltage = (float)adc_value * 5.0f / 1024.0f;
+    *temperature = (voltage - 0.5f) * 100.0f;
+
+    /* Sanity check */
+    if (*temperature < -40.0f || *temperature > 125.0f) {
+        return STATUS_ERROR_HARDWARE;
+    }
+
+    temp_sensor.last_reading = *temperature;
+    return STATUS_OK;
+}
+
+/* Temperature Sensor Array Driver: all channels, one scan */
+typedef struct {
+    bool initialized;
+    uint8_t count;
+    uint8_t channels[HAL_ADC_CHANNELS];
+    uint16_t raw[HAL_ADC_CHANNELS];        /* Last scan, for diagnostics */
+} temp_array_t;
+
+static temp_array_t temp_array = {0};
+
+status_t temp_sensor_init_all(const uint8_t *channels, size_t n) {
+    if (channels == NULL || n == 0 || n > HAL_ADC_CHANNELS) {
+        return STATUS_ERROR_INVALID_PARAM;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (channels[i] >= HAL_ADC_CHANNELS) {
+            return STATUS_ERROR_INVALID_PARAM;
+        }
+        temp_array.channels[i] = channels[i];
+    }
+
+    status_t status = hal_adc_init();
+    if (status != STATUS_OK) {
+        return status;
+    }
+
+    temp_array.count = (uint8_t)n;
+    temp_array.initialized = true;
+    return STATUS_OK;
+}
+
+/*
+ * Read and convert every configured channel. centi_c[i] is channel i of
+ * the list given to temp_sensor_init_all(), in 0.01 C. Out-of-range
+ * readings are still converted (for logging) and flagged in *faults,
+ * bit i per channel. *over counts the in-range channels above
+ * alarm_centi. The call only fails if the scan itself fails.
+ */
+status_t temp_sensor_read_all(int16_t *restrict centi_c, size_t n, int16_t alarm_centi,
+                              uint64_t *faults, uint32_t *over) {
+    if (!temp_array.initialized) {
+        return STATUS_ERROR_INIT;
+    }
+    if (centi_c == NULL || faults == NULL || over == NULL || n != temp_array.count) {
+        return STATUS_ERROR_INVALID_PARAM;
+    }
+
+    status_t status = hal_adc_read_many(temp_array.channels, temp_array.raw, n);
+    if (status != STATUS_OK) {
+        return status;
+    }
+
+    /*
+     * One branch-free pass over the snapshot: convert, range-check and
+     * threshold each sample while it is in a register. Accumulators are
+     * locals, so nothing is stored to memory except centi_c[i].
+     * A shorted sensor reads up to 449.5 C, past int16_t, so saturate;
+     * the range check runs on the unsaturated value.
+     */
+    const uint16_t *restrict raw = temp_array.raw;
+    uint64_t mask = 0;
+    uint32_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        int32_t t = adc_to_centi_celsius(raw[i]);
+        uint32_t bad = (t < TEMP_MIN_CENTI) | (t > TEMP_MAX_CENTI);
+        centi_c[i] = (int16_t)(t > INT16_MAX ? INT16_MAX : t);
+        mask |= (uint64_t)bad << i;
+        count += (uint32_t)(t > alarm_centi) & (bad ^ 1u);
+    }
+    *faults = mask;
+    *over = count;
+    return STATUS_OK;
+}
+
+/* ============================================================================
+ * LAYER 3/4: APPLICATION
+ * ============================================================================ */
+
+#define NUM_SENSORS  64
+
+static const int16_t temp_threshold_centi = 3850;   /* 38.50 C */
+
+typedef struct {
+    uint32_t scans;
+    uint32_t over_threshold;    /* Channels over threshold, last scan */
+    uint64_t faults;            /* Fault mask, last scan */
+} app_context_t;
+
+static app_context_t app = {0};
+static int16_t temps[NUM_SENSORS];
+
+status_t app_init(void) {
+    uint8_t channels[NUM_SENSORS];
+    for (uint8_t i = 0; i < NUM_SENSORS; i++) {
+        channels[i] = i;
+    }
+    return temp_sensor_init_all(channels, NUM_SENSORS);
+}
+
+status_t app_task(void) {
+    status_t status = temp_sensor_read_all(temps, NUM_SENSORS, temp_threshold_centi,
+                                           &app.faults, &app.over_threshold);
+    if (status != STATUS_OK) {
+        return status;
+    }
+
+    app.scans++;
+    return STATUS_OK;
+}
+
+/* ============================================================================
+ * DEMO AND BENCHMARK
+ * ============================================================================ */
+
+#define BENCH_SCANS 200000
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* A plausible plant: a gradient across the channels, one shorted sensor */
+static void sim_fill_scan(uint32_t seed) {
+    for (int i = 0; i < HAL_ADC_CHANNELS; i++) {
+        sim_adc_data[i] = (uint16_t)(140 + i + (seed + (uint32_t)i * 7) % 13);
+    }
+    sim_adc_data[42] = 1023;
+}
+
+/* The 04_production.c way: re-point the driver and read one at a time */
+static double bench_single(void) {
+    float t;
+    volatile uint32_t over = 0;
+    double start = now_sec();
+    for (int s = 0; s < BENCH_SCANS; s++) {
+        for (uint8_t c = 0; c < NUM_SENSORS; c++) {
+            temp_sensor.channel = c;
+            if (temp_sensor_read(&t) == STATUS_OK && t > 38.5f) {
+                over++;
+            }
+        }
+    }
+    return (now_sec() - start) * 1e9 / BENCH_SCANS;
+}
+
+static double bench_batch(void) {
+    double start = now_sec();
+    for (int s = 0; s < BENCH_SCANS; s++) {
+        app_task();
+    }
+    return (now_sec() - start) * 1e9 / BENCH_SCANS;
+}
+
+/* 0.01 C as "-0.05": sign printed on its own, both parts as magnitudes */
+static void print_centi(int32_t centi) {
+    printf("%s%d.%02d", centi < 0 ? "-" : "", abs(centi / 100), abs(centi % 100));
+}
+
+int main(void) {
+    printf("=== Batched ADC Acquisition (%d channels) ===\n\n", NUM_SENSORS);
+
+    if (temp_sensor_init(0) != STATUS_OK || app_init() != STATUS_OK) {
+        printf("Init failed\n");
+        return 1;
+    }
+
+    /* 1. Validation still happens, once per scan */
+    uint8_t bad_list[] = {0, 1, 64};
+    uint16_t bad_out[3];
+    printf("Scan with channel 64: %s\n",
+           hal_adc_read_many(bad_list, bad_out, 3) == STATUS_ERROR_INVALID_PARAM
+           ? "rejected (INVALID_PARAM)" : "accepted?!");
+
+    /* 2. One scan, integer conversion vs the float path */
+    sim_fill_scan(0);
+    app_task();
+
+    /* Every ADC code, not just this scan: integer vs float, in 0.01 C */
+    int max_diff = 0;
+    for (int adc = 0; adc < 1024; adc++) {
+        float t = ((float)adc * 5.0f / 1024.0f - 0.5f) * 100.0f;
+        int diff = (int)(t * 100.0f + (t < 0 ? -0.5f : 0.5f)) - adc_to_centi_celsius((uint16_t)adc);
+        if (diff < 0) diff = -diff;
+        if (diff > max_diff) max_diff = diff;
+    }
+
+    printf("\n--- Scan ---\n");
+    for (int c = 0; c < 8; c++) {
+        printf("  ch%-2d ADC %4u -> ", c, temp_array.raw[c]);
+        print_centi(temps[c]);
+        printf(" C\n");
+    }
+    printf("  ...\n");
+    printf("  %u channel(s) over ", app.over_threshold);
+    print_centi(temp_threshold_centi);
+    printf(" C, fault mask 0x%016llx\n", (unsigned long long)app.faults);
+    printf("  Largest difference vs float path (all 1024 codes): %d x 0.01 C\n", max_diff);
+
+    /* 3. Cost of a full scan */
+    printf("\n=== Cost per %d-channel scan (%d scans) ===\n", NUM_SENSORS, BENCH_SCANS);
+    double t_single = bench_single();
+    double t_batch = bench_batch();
+    printf("64 x temp_sensor_read (float):    %7.1f ns\n", t_single);
+    printf("temp_sensor_read_all (integer):   %7.1f ns\n", t_batch);
+    printf("Ratio: %.1fx. On a host with an FPU the two are within run-to-run\n"
+           "       noise; the float path only falls behind on parts without one,\n"
+           "       where every multiply is a soft-float call\n", t_single / t_batch);
+
+    printf("\n=== Batched Acquisition Features ===\n");
+    printf("✅ One HAL call per scan, channel list checked in one pass\n");
+    printf("✅ Integer conversion over the whole batch (no FPU needed)\n");
+    printf("✅ Faults reported per channel as a bitmask\n");
+    printf("✅ Single-channel API kept for slow, one-off reads\n");
+
+    return 0;
+}
+
+/*
+ * BATCHED ACQUISITION NOTES:
+ *
+ * 1. WHERE THE TIME GOES
+ *    - Per channel: driver checks + call + HAL checks + float math
+ *    - Per scan now: one call, one pass of checks, one copy out of the
+ *      volatile buffer, one fused integer loop
+ *    - Measured on a desktop CPU the two paths cost about the same:
+ *      the per-scan work is dominated by the 64 volatile loads either
+ *      way, and the FPU makes float conversion cheap. The gain is on
+ *      FPU-less MCUs and in call overhead across real driver layers
+ *
+ * 2. HARDWARE FIT
+ *    - ADC sequencers convert a channel list back to back and DMA the
+ *      results; hal_adc_read_many() maps directly onto that
+ *    - On Linux IIO this is the buffered interface (scan_elements +
+ *      /dev/iio:deviceN), one read() per scan instead of one per file
+ *
+ * 3. UNITS
+ *    - 0.01 C in int16_t covers -327..327 C, plenty for -40..125
+ *    - The threshold is stored in the same units: no conversion at
+ *      compare time
+ *
+ * 4. ERRORS
+ *    - A bad channel list is a programming error: whole call fails
+ *    - A bad reading is a sensor problem: that channel is flagged, the
+ *      other 63 are still usable
+ */
@@ -0,0 +1,471 @@
+/**
+ * 08_fixed_point_temp.c - Fixed-Point Temperature Pipeline
+ *
+ * temp_sensor_read() in 04_production.c converts every sample with
+ *     voltage = adc * 5.0f / 1024.0f;  temp = (voltage - 0.5f) * 100.0f;
+ * then range-checks and compares against the threshold in float. On a
+ * part without an FPU each of those is a soft-float library call.
+ *
+ * This version keeps temperatures in Q7.8 fixed point (int16_t, 1/256 C):
+ * - Conversion is one multiply and one subtract: for this sensor
+ *   500/1024 C per count is exactly 125/256, so the Q7.8 value is exact
+ * - Optional 1024-entry lookup table (-DTEMP_USE_LUT): one load per
+ *   sample, and out-of-range codes are pre-marked in the table
+ * - config.temp_threshold is stored in Q7.8, so app_task compares
+ *   integers and never converts
+ * - Verified against the float path for every ADC code: identical
+ *   (tolerance 0, see check_against_float())
+ *
+ * Compile: gcc -O2 -std=c11 08_fixed_point_temp.c -o fixed_point_temp
+ *          gcc -O2 -std=c11 -DTEMP_USE_LUT 08_fixed_point_temp.c -o fixed_point_lut
+ * Run:     ./fixed_point_temp
+ *
+ * Study time: 20 minutes
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+
+/* ============================================================================
+ * ERROR CODES
+ * ============================================================================ */
+typedef enum {
+    STATUS_OK = 0,
+    STATUS_ERROR_INIT,
+    STATUS_ERROR_TIMEOUT,
+    STATUS_ERROR_INVALID_PARAM,
+    STATUS_ERROR_HARDWARE
+} status_t;
+
+/* ============================================================================
+ * FIXED-POINT TEMPERATURE TYPE
+ * ============================================================================ */
+
+/*
+ * Q7.8: 1 sign bit, 7 integer bits, 8 fraction bits.
+ * Range -128.0 .. +127.996 C, resolution 1/256 C (0.0039 C), which is
+ * finer than the sensor's 0.49 C per ADC count. The valid sensor range
+ * (-40..125 C) fits; anything outside is rejected before narrowing.
+ */
+typedef int16_t temp_q_t;
+
+#define TEMP_Q_FRAC_BITS   8
+#define TEMP_Q_ONE         (1 << TEMP_Q_FRAC_BITS)
+
+/* Compile-time constant from degrees C: TEMP_Q(38.5) == 9856 */
+#define TEMP_Q(celsius)    ((temp_q_t)((celsius) * TEMP_Q_ONE))
+
+#define TEMP_Q_MIN         TEMP_Q(-40)
+#define TEMP_Q_MAX         TEMP_Q(125)
+#define TEMP_Q_INVALID     INT16_MIN      /* LUT marker: out of range */
+
+/* For display and logging only; never on the control path */
+static inline float temp_q_to_float(temp_q_t q) {
+    return (float)q / TEMP_Q_ONE;
+}
+
+/* ============================================================================
+ * LAYER 1: HAL (as in 04_production.c)
+ * ============================================================================ */
+
+static volatile uint16_t sim_adc_value = 512;
+
+status_t hal_adc_init(void) {
+    /* Initialize ADC */
+    return STATUS_OK;
+}
+
+status_t hal_adc_read(uint8_t channel, uint16_t *value) {
+    if (value == NULL || channel > 15) {
+        return STATUS_ERROR_INVALID_PARAM;
+    }
+
+    *value = sim_adc_value & 0x3FF;       /* 10-bit converter */
+    return STATUS_OK;
+}
+
+/* ============================================================================
+ * LAYER 2: DRIVERS
+ * ============================================================================ */
+
+/*
+ * ADC counts -> Q7.8 degrees C.
+ *   T = (adc * 5 / 1024 - 0.5) * 100 = adc * 125/256 - 50
+ *   T * 256 = adc * 125 - 12800
+ * No rounding anywhere: the result is the exact temperature. int32 keeps
+ * the out-of-range codes (up to 449.5 C) representable for the check.
+ */
+static inline int32_t temp_adc_to_q32(uint16_t adc) {
+    return (int32_t)adc * 125 - 50 * TEMP_Q_ONE;
+}
+
+static inline bool temp_adc_to_q_calc(uint16_t adc, temp_q_t *out) {
+    int32_t t = temp_adc_to_q32(adc);
+    if (t < TEMP_Q_MIN || t > TEMP_Q_MAX) {
+        return false;
+    }
+    *out = (temp_q_t)t;
+    return true;
+}
+
+/*
+ * Lookup table: one entry per ADC code, 2 KB. Codes outside the sensor
+ * range hold TEMP_Q_INVALID, so conversion and range check are one load
+ * and one compare. For a linear sensor the multiply is already cheap;
+ * the table pays off on cores without a single-cycle multiplier and for
+ * non-linear sensors (NTC thermistors), where it replaces a polynomial.
+ * Built at init here; on an MCU generate it offline into const flash.
+ */
+#define TEMP_LUT_SIZE 1024
+
+static temp_q_t temp_lut[TEMP_LUT_SIZE];
+
+static void temp_lut_init(void) {
+    for (uint16_t adc = 0; adc < TEMP_LUT_SIZE; adc++) {
+        temp_q_t q;
+        temp_lut[adc] = temp_adc_to_q_calc(adc, &q) ? q : TEMP_Q_INVALID;
+    }
+}
+
+static inline bool temp_adc_to_q_lut(uint16_t adc, temp_q_t *out) {
+    temp_q_t q = temp_lut[adc & (TEMP_LUT_SIZE - 1)];
+    *out = q;
+    return q != TEMP_Q_INVALID;
+}
+
+#ifdef TEMP_USE_LUT
+#define temp_adc_to_q   temp_adc_to_q_lut
+#define TEMP_CONVERSION "lookup table"
+#else
+#define temp_adc_to_q   temp_adc_to_q_calc
+#define TEMP_CONVERSION "multiply"
+#endif
+
+/* Temperature Sensor Driver */
+typedef struct {
+    bool initialized;
+    uint8_t channel;
+    temp_q_t last_reading;
+} temp_sensor_t;
+
+static temp_sensor_t temp_sensor = {0};
+
+status_t temp_sensor_init(uint8_t channel) {
+    status_t status;
+
+    if (channel > 15) {
+        return STATUS_ERROR_INVALID_PARAM;
+    }
+
+    status = hal_adc_init();
+    if (status != STATUS_OK) {
+        return status;
+    }
+
+    temp_lut_init();
+
+    temp_sensor.channel = channel;
+    temp_sensor.initialized = true;
+    temp_sensor.last_reading = 0;
+
+    return STATUS_OK;
+}
+
+status_t temp_sensor_read(temp_q_t *temperature) {
+    uint16_t adc_value;
+    status_t status;
+
+    if (!temp_sensor.initialized) {
+        return STATUS_ERROR_INIT;
+    }
+
+    if (temperature == NULL) {
+        return STATUS_ERROR_INVALID_PARAM;
+    }
+
+    status = hal_adc_read(temp_sensor.channel, &adc_value);
+    if (status != STATUS_OK) {
+        return status;
+    }
+
+    /* Convert + sanity check in one step */
+    if (!temp_adc_to_q(adc_value, temperature)) {
+        return STATUS_ERROR_HARDWARE;
+    }
+
+    temp_sensor.last_reading = *temperature;
+    return STATUS_OK;
+}
+
+/* The float path from 04_production.c, kept as the reference */
+static status_t temp_sensor_read_float(float *temperature) {
+    uint16_t adc_value;
+    status_t status = hal_adc_read(temp_sensor.channel, &adc_value);
+    if (status != STATUS_OK) {
+        return status;
+    }
+
+    float voltage = (float)adc_value * 5.0f / 1024.0f;
+    *temperature = (voltage - 0.5f) * 100.0f;
+
+    if (*temperature < -40.0f || *temperature > 125.0f) {
+        return STATUS_ERROR_HARDWARE;
+    }
+    return STATUS_OK;
+}
+
+/* Alarm Driver (as in 04_production.c) */
+static bool alarm_active = false;
+
+status_t alarm_set_state(bool active) {
+    alarm_active = active;
+    return STATUS_OK;
+}
+
+/* ============================================================================
+ * LAYER 3: SERVICES
+ * ============================================================================ */
+
+/* Configuration Service: threshold in the same units as the readings */
+typedef struct {
+    temp_q_t temp_threshold;
+    uint32_t log_interval;
+    bool initialized;
+} config_t;
+
+static config_t config = {
+    .temp_threshold = TEMP_Q(38.5),
+    .log_interval = 300,
+    .initialized = false
+};
+
+status_t config_init(void) {
+    /* Load from EEPROM or use defaults (stored as Q7.8 too) */
+    config.initialized = true;
+    return STATUS_OK;
+}
+
+status_t config_get_temp_threshold(temp_q_t *threshold) {
+    if (!config.initialized || threshold == NULL) {
+        return STATUS_ERROR_INVALID_PARAM;
+    }
+    *threshold = config.temp_threshold;
+    return STATUS_OK;
+}
+
+/* ============================================================================
+ * LAYER 4: APPLICATION
+ * ============================================================================ */
+
+typedef struct {
+    uint32_t error_count;
+    uint32_t tick_count;
+} app_context_t;
+
+static app_context_t app = {0};
+
+status_t app_init(void) {
+    status_t status = config_init();
+    if (status != STATUS_OK) {
+        return status;
+    }
+    return temp_sensor_init(0);
+}
+
+status_t app_task(void) {
+    status_t status;
+    temp_q_t temperature;
+    temp_q_t threshold;
+
+    status = temp_sensor_read(&temperature);
+    if (status != STATUS_OK) {
+        app.error_count++;
+        return status;
+    }
+    app.error_count = 0;
+
+    status = config_get_temp_threshold(&threshold);
+    if (status != STATUS_OK) {
+        return status;
+    }
+
+    /* Integer compare: no conversion, no float */
+    status = alarm_set_state(temperature > threshold);
+    if (status != STATUS_OK) {
+        return status;
+    }
+
+    app.tick_count++;
+    return STATUS_OK;
+}
+
+/* ============================================================================
+ * VERIFICATION AND BENCHMARK
+ * ============================================================================ */
+
+/*
+ * Tolerance: 0. For every one of the 1024 ADC codes
+ * - both paths agree on valid/invalid (range check)
+ * - the Q7.8 value converted to float equals the float path bit for bit
+ *   (adc * 5 / 1024, - 0.5 and * 100 are all exact in binary32 for
+ *   10-bit inputs, and the Q7.8 value is the exact temperature)
+ * - the lookup table matches the multiply for every code
+ */
+static bool check_against_float(int *mismatches) {
+    *mismatches = 0;
+    for (uint16_t adc = 0; adc < 1024; adc++) {
+        float f;
+        temp_q_t q_calc, q_lut;
+
+        sim_adc_value = adc;
+        bool ok_float = (temp_sensor_read_float(&f) == STATUS_OK);
+        bool ok_calc = temp_adc_to_q_calc(adc, &q_calc);
+        bool ok_lut = temp_adc_to_q_lut(adc, &q_lut);
+
+        if (ok_float != ok_calc || ok_calc != ok_lut) {
+            (*mismatches)++;
+        } else if (ok_calc && (temp_q_to_float(q_calc) != f || q_calc != q_lut)) {
+            (*mismatches)++;
+        }
+    }
+    return *mismatches == 0;
+}
+
+#define BENCH_SAMPLES 1024
+#define BENCH_PASSES  20000
+
+static uint16_t bench_adc[BENCH_SAMPLES];
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Convert, range-check and compare, as app_task does per sample */
+static double bench_float(void) {
+    const float threshold = 38.5f;
+    uint32_t over = 0;
+    double start = now_sec();
+    for (int p = 0; p < BENCH_PASSES; p++) {
+        for (int i = 0; i < BENCH_SAMPLES; i++) {
+            float voltage = (float)bench_adc[i] * 5.0f / 1024.0f;
+            float t = (voltage - 0.5f) * 100.0f;
+            over += (t >= -40.0f && t <= 125.0f && t > threshold);
+        }
+        __asm__ volatile("" : : "r"(over) : "memory");
+    }
+    return (now_sec() - start) * 1e9 / ((double)BENCH_PASSES * BENCH_SAMPLES);
+}
+
+/* Same work in Q7.8; written branch-free like the float loop above */
+static double bench_q_calc(void) {
+    const temp_q_t threshold = config.temp_threshold;
+    uint32_t over = 0;
+    double start = now_sec();
+    for (int p = 0; p < BENCH_PASSES; p++) {
+        for (int i = 0; i < BENCH_SAMPLES; i++) {
+            int32_t t = temp_adc_to_q32(bench_adc[i]);
+            over += (t >= TEMP_Q_MIN) & (t <= TEMP_Q_MAX) & (t > threshold);
+        }
+        __asm__ volatile("" : : "r"(over) : "memory");
+    }
+    return (now_sec() - start) * 1e9 / ((double)BENCH_PASSES * BENCH_SAMPLES);
+}
+
+static double bench_q_lut(void) {
+    const temp_q_t threshold = config.temp_threshold;
+    uint32_t over = 0;
+    double start = now_sec();
+    for (int p = 0; p < BENCH_PASSES; p++) {
+        for (int i = 0; i < BENCH_SAMPLES; i++) {
+            temp_q_t t = temp_lut[bench_adc[i] & (TEMP_LUT_SIZE - 1)];
+            over += (t != TEMP_Q_INVALID) & (t > threshold);
+        }
+        __asm__ volatile("" : : "r"(over) : "memory");
+    }
+    return (now_sec() - start) * 1e9 / ((double)BENCH_PASSES * BENCH_SAMPLES);
+}
+
+int main(void) {
+    printf("=== Fixed-Point Temperature Pipeline (Q7.8, %s) ===\n\n", TEMP_CONVERSION);
+
+    if (app_init() != STATUS_OK) {
+        printf("Init failed\n");
+        return 1;
+    }
+
+    /* 1. Equivalence with the float path */
+    int mismatches;
+    bool identical = check_against_float(&mismatches);
+    printf("Threshold: %.2f C stored as %d (Q7.8)\n",
+           temp_q_to_float(config.temp_threshold), config.temp_threshold);
+    printf("All 1024 ADC codes vs float path: %s (%d mismatches)\n",
+           identical ? "✅ identical" : "❌ differ", mismatches);
+
+    /* 2. Application on integers only */
+    printf("\n--- Application ---\n");
+    const uint16_t samples[] = {150, 180, 181, 185, 1023, 170};
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        sim_adc_value = samples[i];
+        status_t status = app_task();
+        if (status == STATUS_OK) {
+            printf("  ADC %4u -> %6d (%7.3f C)  alarm %s\n", samples[i],
+                   temp_sensor.last_reading, temp_q_to_float(temp_sensor.last_reading),
+                   alarm_active ? "ON" : "off");
+        } else {
+            printf("  ADC %4u -> out of range, rejected\n", samples[i]);
+        }
+    }
+
+    /* 3. Cost per sample: convert + range check + threshold compare */
+    uint32_t seed = 1;
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        seed = seed * 1103515245u + 12345u;
+        bench_adc[i] = (uint16_t)(120 + (seed >> 16) % 250);
+    }
+    printf("\n=== Cost per Sample (%d x %d) ===\n", BENCH_PASSES, BENCH_SAMPLES);
+    printf("float:               %.2f ns\n", bench_float());
+    printf("Q7.8 multiply:       %.2f ns\n", bench_q_calc());
+    printf("Q7.8 lookup table:   %.2f ns  (%zu bytes of table)\n",
+           bench_q_lut(), sizeof(temp_lut));
+    printf("(This host has an FPU. Without one, each float op above is\n"
+           " a library call and the fixed-point paths win by far more.)\n");
+
+    printf("\n=== Fixed-Point Features ===\n");
+    printf("✅ Q7.8 readings, exact for this sensor\n");
+    printf("✅ Threshold in the same units: integer compare\n");
+    printf("✅ Optional LUT with built-in range check\n");
+    printf("✅ Verified identical to float for every ADC code\n");
+
+    return 0;
+}
+
+/*
+ * FIXED-POINT NOTES:
+ *
+ * 1. CHOOSING THE FORMAT
+ *    - Integer bits: cover the valid range (+-128 C for -40..125)
+ *    - Fraction bits: finer than the sensor (1/256 C vs 0.49 C/count)
+ *    - Pick the scale so the conversion constant is exact: here
+ *      500/1024 * 256 = 125, so no rounding error at all
+ *
+ * 2. WHEN THE CONSTANT IS NOT EXACT
+ *    - Other references/sensors give e.g. 3.3 V / 4096: round the
+ *      constant, then document the worst-case error (half an LSB of
+ *      the output format) and test every input code, as done here
+ *
+ * 3. KEEP UNITS CONSISTENT
+ *    - Thresholds, hysteresis and calibration offsets all in Q7.8
+ *    - Convert to float/text only at the edges (display, logs)
+ *
+ * 4. LOOKUP TABLE TRADE-OFF
+ *    - 2 KB of flash for 10-bit codes; 8 KB for 12-bit
+ *    - One load per sample; invalid codes handled for free
+ *    - Non-linear sensors: the table absorbs the curve fit
+ */
@@ -0,0 +1,497 @@
+/**
+ * 10_config_rcu.c - Config Service with Lock-Free Versioned Snapshots
+ *
+ * config_get_temp_threshold() in 04_production.c checks
+ * config.initialized and copies one field, every app_task tick. Nothing
+ * protects the struct, so another thread (a console, a network update)
+ * cannot change it safely: a reader could see the new threshold with the
+ * old hysteresis. concepts/07_rwlock/02_config_cache.c fixes that with a
+ * pthread rwlock, which makes every read a lock/unlock pair on a shared
+ * cache line.
+ *
+ * This version publishes IMMUTABLE snapshots (RCU style):
+ * - Readers: one acquire load of an atomic pointer, then plain reads of
+ *   a snapshot nobody will modify. No lock, no shared write.
+ * - Writers: copy, modify, stamp a new version, swap the pointer.
+ * - Reclamation is deferred: an old snapshot goes back to the pool only
+ *   after every reader thread has passed a quiescent state (the end of
+ *   its app_task tick), so no reader can still hold it.
+ * - Snapshots come from a static pool (no malloc in the services layer)
+ *
+ * Benchmarked against the rwlock version with a writer updating every
+ * millisecond.
+ *
+ * Compile: gcc -O2 -std=c11 -pthread 10_config_rcu.c -o config_rcu
+ * Run:     ./config_rcu
+ *
+ * Study time: 30 minutes
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * ERROR CODES
+ * ============================================================================ */
+typedef enum {
+    STATUS_OK = 0,
+    STATUS_ERROR_INIT,
+    STATUS_ERROR_TIMEOUT,
+    STATUS_ERROR_INVALID_PARAM,
+    STATUS_ERROR_HARDWARE
+} status_t;
+
+typedef int16_t temp_q_t;                 /* Q7.8, as in 08_fixed_point_temp.c */
+#define TEMP_Q(celsius)   ((temp_q_t)((celsius) * 256))
+
+#define CACHE_LINE 64
+
+/* ============================================================================
+ * LAYER 3: SERVICES - CONFIGURATION SNAPSHOTS
+ * ============================================================================ */
+
+typedef struct {
+    uint32_t version;
+    temp_q_t temp_threshold;
+    temp_q_t hysteresis;
+    uint32_t log_interval;
+    uint32_t check;           /* Derived from the fields: detects torn reads */
+} config_snapshot_t;
+
+#define CONFIG_POOL_SIZE    8
+#define CONFIG_MAX_READERS  32
+#define CONFIG_SYNC_TIMEOUT_MS 100
+
+static uint32_t config_check(const config_snapshot_t *c) {
+    return c->version * 2654435761u ^ (uint16_t)c->temp_threshold ^
+           ((uint32_t)(uint16_t)c->hysteresis << 16) ^ c->log_interval;
+}
+
+/* A retired snapshot waits here until grace period 'gp' has passed */
+typedef struct {
+    config_snapshot_t *snapshot;
+    uint64_t gp;
+} config_retired_t;
+
+/* Per-reader quiescent-state counter, one cache line each */
+typedef struct {
+    _Alignas(CACHE_LINE) _Atomic uint64_t seen_gp;  /* 0 = offline (holds no snapshot) */
+    char pad[CACHE_LINE - sizeof(uint64_t)];
+} config_reader_t;
+
+_Static_assert(sizeof(config_reader_t) == CACHE_LINE, "one reader slot per cache line");
+
+typedef struct {
+    _Alignas(CACHE_LINE) _Atomic(config_snapshot_t *) current;
+    _Alignas(CACHE_LINE) _Atomic uint64_t gp_counter;
+    config_reader_t readers[CONFIG_MAX_READERS];
+    _Atomic uint32_t num_readers;
+
+    /* Writer side, serialized by write_lock */
+    pthread_mutex_t    write_lock;
+    config_snapshot_t  pool[CONFIG_POOL_SIZE];
+    bool               in_use[CONFIG_POOL_SIZE];
+    config_retired_t   retired[CONFIG_POOL_SIZE];
+    uint32_t           num_retired;
+    uint32_t           reclaimed;
+    uint32_t           sync_waits;   /* Times a writer had to wait for readers */
+} config_service_t;
+
+/* Readers must not share a line with gp_counter, which the writer bumps */
+_Static_assert(offsetof(config_service_t, readers) % CACHE_LINE == 0,
+               "reader slots start on a cache line");
+_Static_assert(offsetof(config_service_t, readers) >=
+               offsetof(config_service_t, gp_counter) + CACHE_LINE,
+               "reader slots do not share gp_counter's line");
+
+static config_service_t config = {
+    .write_lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+status_t config_init(void) {
+    config_snapshot_t *first = &config.pool[0];
+
+    first->version = 1;
+    first->temp_threshold = TEMP_Q(38.5);
+    first->hysteresis = TEMP_Q(0.5);
+    first->log_interval = 300;
+    first->check = config_check(first);
+
+    config.in_use[0] = true;
+    atomic_store(&config.gp_counter, 1);
+    atomic_store_explicit(&config.current, first, memory_order_release);
+    return STATUS_OK;
+}
+
+/* ---------------------------------------------------------------------------
+ * Reader side
+ * --------------------------------------------------------------------------- */
+
+/* Each thread that reads config registers once and keeps its id */
+int config_reader_register(void) {
+    uint32_t id = atomic_fetch_add(&config.num_readers, 1);
+    if (id >= CONFIG_MAX_READERS) {
+        return -1;
+    }
+    atomic_store(&config.readers[id].seen_gp, atomic_load(&config.gp_counter));
+    return (int)id;
+}
+
+/*
+ * The hot path: one load. The snapshot stays valid until this thread's
+ * next config_quiescent(); do not keep the pointer past that.
+ */
+static inline const config_snapshot_t *config_read(void) {
+    return atomic_load_explicit(&config.current, memory_order_acquire);
+}
+
+/*
+ * "I hold no snapshot pointer now." Call once per tick (end of app_task).
+ * Publishing the current grace period number lets writers reclaim
+ * everything retired before it.
+ */
+static inline void config_quiescent(int reader_id) {
+    uint64_t gp = atomic_load(&config.gp_counter);
+    atomic_store(&config.readers[reader_id].seen_gp, gp);
+}
+
+/* Long sleep / thread exit: stop holding back reclamation */
+void config_reader_offline(int reader_id) {
+    atomic_store(&config.readers[reader_id].seen_gp, 0);
+}
+
+/* ---------------------------------------------------------------------------
+ * Writer side
+ * --------------------------------------------------------------------------- */
+
+/* Oldest grace period any online reader may still be inside */
+static uint64_t config_oldest_reader_gp(void) {
+    uint64_t oldest = UINT64_MAX;
+    uint32_t n = atomic_load(&config.num_readers);
+    if (n > CONFIG_MAX_READERS) n = CONFIG_MAX_READERS;
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint64_t seen = atomic_load(&config.readers[i].seen_gp);
+        if (seen != 0 && seen < oldest) {
+            oldest = seen;
+        }
+    }
+    return oldest;
+}
+
+/* Return to the pool every retired snapshot no reader can still see */
+static void config_reclaim_locked(void) {
+    uint64_t oldest = config_oldest_reader_gp();
+    uint32_t kept = 0;
+
+    for (uint32_t i = 0; i < config.num_retired; i++) {
+        config_retired_t r = config.retired[i];
+        if (r.gp <= oldest) {
+            config.in_use[r.snapshot - config.pool] = false;
+            config.reclaimed++;
+        } else {
+            config.retired[kept++] = r;
+        }
+    }
+    config.num_retired = kept;
+}
+
+static config_snapshot_t *config_alloc_locked(void) {
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (;;) {
+        config_reclaim_locked();
+        for (int i = 0; i < CONFIG_POOL_SIZE; i++) {
+            if (!config.in_use[i]) {
+                config.in_use[i] = true;
+                return &config.pool[i];
+            }
+        }
+
+        /* Pool full of snapshots readers may hold: wait for a tick */
+        config.sync_waits++;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long ms = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+        if (ms > CONFIG_SYNC_TIMEOUT_MS) {
+            return NULL;      /* A reader stopped calling config_quiescent() */
+        }
+        sched_yield();
+    }
+}
+
+/*
+ * Publish a new configuration. 'update' receives a private copy of the
+ * current snapshot to modify; readers never see it half-written.
+ */
+status_t config_update(void (*update)(config_snapshot_t *next, void *arg), void *arg) {
+    if (update == NULL) {
+        return STATUS_ERROR_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&config.write_lock);
+
+    config_snapshot_t *next = config_alloc_locked();
+    if (next == NULL) {
+        pthread_mutex_unlock(&config.write_lock);
+        return STATUS_ERROR_TIMEOUT;
+    }
+
+    config_snapshot_t *old = atomic_load(&config.current);
+    *next = *old;
+    update(next, arg);
+    next->version = old->version + 1;
+    next->check = config_check(next);
+
+    atomic_store(&config.current, next);
+
+    /*
+     * Readers that report a grace period >= gp did so after the swap,
+     * so they can no longer be holding 'old'.
+     */
+    uint64_t gp = atomic_fetch_add(&config.gp_counter, 1) + 1;
+    config.retired[config.num_retired++] = (config_retired_t){ old, gp };
+    config_reclaim_locked();
+
+    pthread_mutex_unlock(&config.write_lock);
+    return STATUS_OK;
+}
+
+/* ============================================================================
+ * BASELINE: 07_rwlock/02_config_cache.c pattern
+ * ============================================================================ */
+
+typedef struct {
+    pthread_rwlock_t lock;
+    config_snapshot_t data;
+} config_cache_t;
+
+static config_cache_t cache = {
+    .lock = PTHREAD_RWLOCK_INITIALIZER,
+};
+
+static void cache_update(void (*update)(config_snapshot_t *next, void *arg), void *arg) {
+    pthread_rwlock_wrlock(&cache.lock);
+    update(&cache.data, arg);
+    cache.data.version++;
+    cache.data.check = config_check(&cache.data);
+    pthread_rwlock_unlock(&cache.lock);
+}
+
+/* ============================================================================
+ * LAYER 4: APPLICATION (threshold check, as app_task does)
+ * ============================================================================ */
+
+static void set_threshold(config_snapshot_t *next, void *arg) {
+    next->temp_threshold = (temp_q_t)(intptr_t)arg;
+}
+
+static void bump_threshold(config_snapshot_t *next, void *arg) {
+    (void)arg;
+    next->temp_threshold = (temp_q_t)(TEMP_Q(35) + (next->version % 8) * TEMP_Q(1));
+    next->hysteresis = (temp_q_t)(TEMP_Q(0.25) * (1 + next->version % 4));
+}
+
+/* ============================================================================
+ * BENCHMARK
+ * ============================================================================ */
+
+#define BENCH_MS          400
+#define WRITER_PERIOD_US  1000
+
+static atomic_bool bench_running;
+static atomic_bool bench_go;
+static _Atomic uint32_t bench_alarms;   /* Keeps the threshold check live */
+
+typedef struct {
+    _Alignas(CACHE_LINE) uint64_t reads;
+    uint64_t torn;
+    bool use_rcu;
+} bench_reader_t;
+
+static void *bench_reader(void *p) {
+    bench_reader_t *r = p;
+    temp_q_t temperature = TEMP_Q(37);
+    uint64_t reads = 0, torn = 0;
+    uint32_t alarms = 0;
+    int id = r->use_rcu ? config_reader_register() : -1;
+
+    while (!atomic_load_explicit(&bench_go, memory_order_acquire)) {
+        sched_yield();
+    }
+
+    while (atomic_load_explicit(&bench_running, memory_order_relaxed)) {
+        for (int i = 0; i < 256; i++) {
+            config_snapshot_t c;
+
+            /* One app_task tick: fetch threshold + hysteresis, compare */
+            if (r->use_rcu) {
+                const config_snapshot_t *s = config_read();
+                c = *s;
+            } else {
+                pthread_rwlock_rdlock(&cache.lock);
+                c = cache.data;
+                pthread_rwlock_unlock(&cache.lock);
+            }
+            torn += (c.check != config_check(&c));
+            alarms += (temperature > c.temp_threshold - c.hysteresis);
+            if (r->use_rcu) {
+                config_quiescent(id);
+            }
+            reads++;
+        }
+    }
+
+    if (r->use_rcu) {
+        config_reader_offline(id);
+    }
+    atomic_fetch_add(&bench_alarms, alarms);
+    r->reads = reads;
+    r->torn = torn;
+    return NULL;
+}
+
+static uint64_t bench_writer_updates;
+static uint64_t bench_writer_timeouts;
+
+static void *bench_writer(void *p) {
+    bool use_rcu = *(bool *)p;
+    struct timespec period = { 0, WRITER_PERIOD_US * 1000 };
+    uint64_t updates = 0, timeouts = 0;
+
+    while (!atomic_load(&bench_go)) {
+        sched_yield();
+    }
+    while (atomic_load_explicit(&bench_running, memory_order_relaxed)) {
+        if (!use_rcu) {
+            cache_update(bump_threshold, NULL);
+            updates++;
+        } else if (config_update(bump_threshold, NULL) == STATUS_OK) {
+            updates++;
+        } else {
+            timeouts++;             /* Pool full, readers too slow: not published */
+        }
+        nanosleep(&period, NULL);
+    }
+    bench_writer_updates = updates;
+    bench_writer_timeouts = timeouts;
+    return NULL;
+}
+
+static double bench(bool use_rcu, int num_readers, uint64_t *torn) {
+    pthread_t readers[CONFIG_MAX_READERS], writer;
+    static bench_reader_t args[CONFIG_MAX_READERS];
+    struct timespec run = { BENCH_MS / 1000, (BENCH_MS % 1000) * 1000000L };
+
+    atomic_store(&config.num_readers, 0);
+    atomic_store(&bench_running, true);
+    atomic_store(&bench_go, false);
+
+    for (int i = 0; i < num_readers; i++) {
+        args[i] = (bench_reader_t){ .use_rcu = use_rcu };
+        pthread_create(&readers[i], NULL, bench_reader, &args[i]);
+    }
+    pthread_create(&writer, NULL, bench_writer, &use_rcu);
+
+    atomic_store_explicit(&bench_go, true, memory_order_release);
+    nanosleep(&run, NULL);
+    atomic_store(&bench_running, false);
+
+    uint64_t total = 0;
+    *torn = 0;
+    for (int i = 0; i < num_readers; i++) {
+        pthread_join(readers[i], NULL);
+        total += args[i].reads;
+        *torn += args[i].torn;
+    }
+    pthread_join(writer, NULL);
+
+    return total / (BENCH_MS / 1000.0) / 1e6;
+}
+
+int main(void) {
+    printf("=== Config Service: RCU Snapshots vs Rwlock ===\n\n");
+
+    config_init();
+    cache.data = *config_read();
+
+    /* 1. Versioned, immutable snapshots */
+    int me = config_reader_register();
+    const config_snapshot_t *before = config_read();
+    config_update(set_threshold, (void *)(intptr_t)TEMP_Q(40));
+    const config_snapshot_t *after = config_read();
+    printf("Held snapshot:  v%u threshold %.2f C (unchanged while held)\n",
+           before->version, before->temp_threshold / 256.0);
+    printf("Current:        v%u threshold %.2f C\n",
+           after->version, after->temp_threshold / 256.0);
+    config_quiescent(me);
+    config_update(set_threshold, (void *)(intptr_t)TEMP_Q(38.5));
+    printf("After quiescent state: %u snapshot(s) reclaimed, %u still retired\n",
+           config.reclaimed, config.num_retired);
+    config_reader_offline(me);
+
+    /* 2. Throughput with a writer updating every millisecond */
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("\n=== Reads/sec (Mreads/s), writer every %d us, %ld CPU(s) ===\n",
+           WRITER_PERIOD_US, ncpu);
+    printf("%-8s %12s %12s %8s %10s\n", "readers", "rwlock", "rcu", "speedup", "torn");
+
+    const int thread_counts[] = {1, 2, 4, 8};
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+        uint64_t torn_lock, torn_rcu;
+        double lock = bench(false, thread_counts[i], &torn_lock);
+        double rcu = bench(true, thread_counts[i], &torn_rcu);
+        printf("%-8d %12.1f %12.1f %7.1fx %5llu/%llu\n", thread_counts[i], lock, rcu,
+               rcu / lock, (unsigned long long)torn_lock, (unsigned long long)torn_rcu);
+    }
+    printf("Writer: %llu updates, %llu timed out in the last run, %u pool wait(s) total\n",
+           (unsigned long long)bench_writer_updates,
+           (unsigned long long)bench_writer_timeouts, config.sync_waits);
+    if (ncpu == 1) {
+        printf("(1 CPU: readers take turns, so this measures per-read cost,\n"
+               " not contention on the rwlock's shared counter)\n");
+    }
+
+    printf("\n=== RCU Config Features ===\n");
+    printf("✅ Reader: one atomic load, no lock, no shared write\n");
+    printf("✅ Immutable snapshots: never a half-updated config\n");
+    printf("✅ Version number on every snapshot\n");
+    printf("✅ Deferred reclamation after a quiescent state\n");
+    printf("✅ Static snapshot pool, bounded writer wait\n");
+
+    return 0;
+}
+
+/*
+ * RCU CONFIG NOTES:
+ *
+ * 1. WHY READERS SCALE
+ *    - rwlock: every rdlock/unlock writes the lock's reader count, so
+ *      the cache line bounces between all reading cores
+ *    - RCU: readers only load; each writes only its own padded
+ *      quiescent-state line
+ *
+ * 2. THE RULE READERS MUST FOLLOW
+ *    - Do not keep a snapshot pointer across config_quiescent()
+ *    - Call config_quiescent() regularly (once per task tick), or
+ *      config_reader_offline() before blocking for long
+ *
+ * 3. WRITERS PAY
+ *    - Copy the snapshot, swap, and wait (rarely) for readers before
+ *      reusing memory: fine for config, which changes seldom
+ *
+ * 4. ON A SINGLE-CORE MCU
+ *    - The same pattern works between main loop and ISRs: the ISR
+ *      reads via one pointer load, and the main loop's tick is the
+ *      quiescent state
+ */
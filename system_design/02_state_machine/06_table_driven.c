@@ -0,0 +1,711 @@
+/**
+ * 06_table_driven.c - Table-Driven State Machine Engine
+ *
+ * 04_production.c dispatches with a nested switch on current_state plus
+ * if/else chains on the event, and state_machine_transition() needs two
+ * more switches for exit/entry actions. This version moves all of that
+ * into constant tables:
+ * - transition_table[STATE_MAX][EVENT_MAX] = { target, guard, action }
+ * - entry_table[] / exit_table[] / during_table[] = function pointers
+ * - Dispatch = one indexed lookup, no branching on state or event
+ * - Tables are const: they live in flash, not RAM
+ *
+ * The same washing machine is ported to the engine, checked for
+ * identical behaviour against the switch version, and both are timed.
+ *
+ * Compile: gcc -O2 -std=c11 06_table_driven.c -o table_driven
+ * Run:     ./table_driven
+ *
+ * Study time: 25 minutes
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ============================================================================
+ * ERROR CODES
+ * ============================================================================ */
+typedef enum {
+    STATUS_OK = 0,
+    STATUS_ERROR_INVALID_STATE,
+    STATUS_ERROR_INVALID_EVENT,
+    STATUS_ERROR_DOOR_OPEN,
+    STATUS_ERROR_HARDWARE
+} status_t;
+
+/* ============================================================================
+ * STATE MACHINE DEFINITION (same as 04_production.c)
+ * ============================================================================ */
+
+typedef enum {
+    STATE_IDLE,
+    STATE_FILLING,
+    STATE_WASHING,
+    STATE_DRAINING,
+    STATE_SPINNING,
+    STATE_DONE,
+    STATE_PAUSED,
+    STATE_ERROR,
+    STATE_MAX,
+    STATE_HISTORY = STATE_MAX  /* Pseudo-target: "go back to previous_state" */
+} wash_state_t;
+
+typedef enum {
+    EVENT_START,
+    EVENT_WATER_FULL,
+    EVENT_WASH_DONE,
+    EVENT_DRAIN_DONE,
+    EVENT_SPIN_DONE,
+    EVENT_PAUSE,
+    EVENT_RESUME,
+    EVENT_STOP,
+    EVENT_ERROR,
+    EVENT_RESET,
+    EVENT_NONE,
+    EVENT_MAX
+} wash_event_t;
+
+typedef enum {
+    PROGRAM_NORMAL,
+    PROGRAM_DELICATE,
+    PROGRAM_HEAVY,
+    PROGRAM_QUICK
+} wash_program_t;
+
+typedef struct {
+    uint32_t fill_time;
+    uint32_t wash_time;
+    uint32_t spin_time;
+    uint8_t motor_speed;
+} program_config_t;
+
+const program_config_t programs[] = {
+    [PROGRAM_NORMAL]   = {10, 30, 20, 100},
+    [PROGRAM_DELICATE] = {10, 20, 10, 50},
+    [PROGRAM_HEAVY]    = {15, 45, 30, 100},
+    [PROGRAM_QUICK]    = {5,  15, 10, 100}
+};
+
+typedef struct {
+    wash_state_t current_state;
+    wash_state_t previous_state;
+    wash_program_t program;
+    uint32_t wash_timer;
+    uint32_t spin_timer;
+    uint32_t state_entry_time;
+    uint32_t error_count;
+    bool door_open;
+    bool initialized;
+} wash_machine_t;
+
+static wash_machine_t machine = {0};
+
+const char* state_names[] = {
+    "IDLE", "FILLING", "WASHING", "DRAINING",
+    "SPINNING", "DONE", "PAUSED", "ERROR"
+};
+
+const char* event_names[] = {
+    "START", "WATER_FULL", "WASH_DONE", "DRAIN_DONE",
+    "SPIN_DONE", "PAUSE", "RESUME", "STOP",
+    "ERROR", "RESET", "NONE"
+};
+
+/* Benchmarks run silently; the demo prints everything */
+static bool quiet = false;
+#define LOG(...) do { if (!quiet) printf(__VA_ARGS__); } while (0)
+
+/* ============================================================================
+ * LOGGING & HARDWARE (same as 04_production.c, but can be silenced)
+ * ============================================================================ */
+
+void log_state_change(wash_state_t from, wash_state_t to) {
+    LOG("[LOG] State: %s -> %s\n", state_names[from], state_names[to]);
+}
+
+void log_event(wash_event_t event) {
+    if (event != EVENT_NONE) {
+        LOG("[LOG] Event: %s\n", event_names[event]);
+    }
+}
+
+void log_error(const char* message) {
+    LOG("[ERROR] %s\n", message);
+    machine.error_count++;
+}
+
+status_t hw_lock_door(void)         { LOG("  [HW] Door locked\n");        return STATUS_OK; }
+status_t hw_unlock_door(void)       { LOG("  [HW] Door unlocked\n");      return STATUS_OK; }
+status_t hw_open_water_valve(void)  { LOG("  [HW] Water valve open\n");   return STATUS_OK; }
+status_t hw_close_water_valve(void) { LOG("  [HW] Water valve closed\n"); return STATUS_OK; }
+status_t hw_stop_motor(void)        { LOG("  [HW] Motor stopped\n");      return STATUS_OK; }
+status_t hw_open_drain_valve(void)  { LOG("  [HW] Drain valve open\n");   return STATUS_OK; }
+status_t hw_close_drain_valve(void) { LOG("  [HW] Drain valve closed\n"); return STATUS_OK; }
+
+status_t hw_start_motor(uint8_t speed) {
+    LOG("  [HW] Motor at %d%% speed\n", speed);
+    return STATUS_OK;
+}
+
+void hw_beep(uint8_t count) {
+    LOG("  [HW] BEEP! (%d times)\n", count);
+}
+
+/* ============================================================================
+ * STATE ENTRY/EXIT ACTIONS (same as 04_production.c)
+ * ============================================================================ */
+
+status_t on_enter_idle(void) {
+    hw_unlock_door();
+    machine.wash_timer = 0;
+    machine.spin_timer = 0;
+    return STATUS_OK;
+}
+
+status_t on_enter_filling(void) {
+    status_t status;
+
+    if (machine.door_open) {
+        log_error("Cannot fill with door open");
+        return STATUS_ERROR_DOOR_OPEN;
+    }
+
+    status = hw_lock_door();
+    if (status != STATUS_OK) return status;
+
+    return hw_open_water_valve();
+}
+
+status_t on_exit_filling(void) {
+    return hw_close_water_valve();
+}
+
+status_t on_enter_washing(void) {
+    const program_config_t *config = &programs[machine.program];
+    machine.wash_timer = config->wash_time;
+    return hw_start_motor(config->motor_speed);
+}
+
+status_t on_exit_washing(void) {
+    return hw_stop_motor();
+}
+
+status_t on_enter_draining(void) {
+    return hw_open_drain_valve();
+}
+
+status_t on_exit_draining(void) {
+    return hw_close_drain_valve();
+}
+
+status_t on_enter_spinning(void) {
+    const program_config_t *config = &programs[machine.program];
+    machine.spin_timer = config->spin_time;
+    return hw_start_motor(100);
+}
+
+status_t on_exit_spinning(void) {
+    return hw_stop_motor();
+}
+
+status_t on_enter_done(void) {
+    hw_unlock_door();
+    hw_beep(3);
+    return STATUS_OK;
+}
+
+status_t on_enter_paused(void) {
+    hw_stop_motor();
+    hw_close_water_valve();
+    return STATUS_OK;
+}
+
+status_t on_enter_error(void) {
+    hw_stop_motor();
+    hw_close_water_valve();
+    hw_close_drain_valve();
+    hw_beep(5);
+    return STATUS_OK;
+}
+
+/* ============================================================================
+ * GUARDS, TRANSITION ACTIONS AND DURING-ACTIONS
+ * ============================================================================ */
+
+bool guard_door_closed(void) {
+    return !machine.door_open;
+}
+
+/* Runs while current_state is still the source state */
+status_t action_save_history(void) {
+    machine.previous_state = machine.current_state;
+    return STATUS_OK;
+}
+
+status_t action_clear_errors(void) {
+    machine.error_count = 0;
+    return STATUS_OK;
+}
+
+/*
+ * During-actions run on every event while in a state, before the table
+ * lookup. They may replace the event: an expired timer becomes the
+ * state's completion event, which is exactly what the switch version
+ * does with "event == EVENT_WASH_DONE || machine.wash_timer == 0".
+ */
+wash_event_t during_washing(wash_event_t event) {
+    if (machine.wash_timer > 0) {
+        machine.wash_timer--;
+    }
+    return (machine.wash_timer == 0) ? EVENT_WASH_DONE : event;
+}
+
+wash_event_t during_spinning(wash_event_t event) {
+    if (machine.spin_timer > 0) {
+        machine.spin_timer--;
+    }
+    return (machine.spin_timer == 0) ? EVENT_SPIN_DONE : event;
+}
+
+/* ============================================================================
+ * GENERIC TABLE-DRIVEN ENGINE
+ * ============================================================================ */
+
+typedef bool (*fsm_guard_t)(void);
+typedef status_t (*fsm_action_t)(void);
+typedef wash_event_t (*fsm_during_t)(wash_event_t event);
+
+typedef struct {
+    fsm_guard_t  guard;    /* NULL = always allowed */
+    fsm_action_t action;   /* NULL = none; runs between exit and entry */
+    uint8_t      target;   /* wash_state_t or STATE_HISTORY */
+    bool         handled;  /* false = event ignored in this state */
+} fsm_transition_t;
+
+/* Designated initializer helper: unlisted cells stay {0} = "ignored" */
+#define T(to, g, a)  { .guard = (g), .action = (a), .target = (to), .handled = true }
+
+static const fsm_transition_t transition_table[STATE_MAX][EVENT_MAX] = {
+    [STATE_IDLE] = {
+        [EVENT_START]      = T(STATE_FILLING,  guard_door_closed, NULL),
+    },
+    [STATE_FILLING] = {
+        [EVENT_WATER_FULL] = T(STATE_WASHING,  NULL, NULL),
+        [EVENT_PAUSE]      = T(STATE_PAUSED,   NULL, action_save_history),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+        [EVENT_STOP]       = T(STATE_DRAINING, NULL, NULL),
+    },
+    [STATE_WASHING] = {
+        [EVENT_WASH_DONE]  = T(STATE_DRAINING, NULL, NULL),
+        [EVENT_PAUSE]      = T(STATE_PAUSED,   NULL, action_save_history),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+    },
+    [STATE_DRAINING] = {
+        [EVENT_DRAIN_DONE] = T(STATE_SPINNING, NULL, NULL),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+    },
+    [STATE_SPINNING] = {
+        [EVENT_SPIN_DONE]  = T(STATE_DONE,     NULL, NULL),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+    },
+    [STATE_DONE] = {
+        [EVENT_START]      = T(STATE_FILLING,  guard_door_closed, NULL),
+    },
+    [STATE_PAUSED] = {
+        [EVENT_RESUME]     = T(STATE_HISTORY,  NULL, NULL),
+        [EVENT_STOP]       = T(STATE_IDLE,     NULL, NULL),
+    },
+    [STATE_ERROR] = {
+        [EVENT_RESET]      = T(STATE_IDLE,     NULL, action_clear_errors),
+    },
+};
+
+static const fsm_action_t entry_table[STATE_MAX] = {
+    [STATE_IDLE]     = on_enter_idle,
+    [STATE_FILLING]  = on_enter_filling,
+    [STATE_WASHING]  = on_enter_washing,
+    [STATE_DRAINING] = on_enter_draining,
+    [STATE_SPINNING] = on_enter_spinning,
+    [STATE_DONE]     = on_enter_done,
+    [STATE_PAUSED]   = on_enter_paused,
+    [STATE_ERROR]    = on_enter_error,
+};
+
+static const fsm_action_t exit_table[STATE_MAX] = {
+    [STATE_FILLING]  = on_exit_filling,
+    [STATE_WASHING]  = on_exit_washing,
+    [STATE_DRAINING] = on_exit_draining,
+    [STATE_SPINNING] = on_exit_spinning,
+};
+
+static const fsm_during_t during_table[STATE_MAX] = {
+    [STATE_WASHING]  = during_washing,
+    [STATE_SPINNING] = during_spinning,
+};
+
+/* exit(old) -> action -> state change -> entry(new) */
+static status_t fsm_transition(const fsm_transition_t *t) {
+    wash_state_t old_state = machine.current_state;
+    wash_state_t new_state = (t->target == STATE_HISTORY)
+                             ? machine.previous_state : (wash_state_t)t->target;
+    status_t status;
+
+    if (exit_table[old_state]) {
+        status = exit_table[old_state]();
+        if (status != STATUS_OK) {
+            log_error("Exit action failed");
+            return status;
+        }
+    }
+
+    if (t->action) {
+        status = t->action();
+        if (status != STATUS_OK) {
+            log_error("Transition action failed");
+            return status;
+        }
+    }
+
+    machine.current_state = new_state;
+    machine.state_entry_time = 0;
+    log_state_change(old_state, new_state);
+
+    status = entry_table[new_state]();
+    if (status != STATUS_OK) {
+        log_error("Entry action failed");
+        machine.current_state = STATE_ERROR;
+        on_enter_error();
+    }
+
+    return status;
+}
+
+status_t state_machine_run(wash_event_t event) {
+    if (event >= EVENT_MAX) {
+        return STATUS_ERROR_INVALID_EVENT;
+    }
+    if (machine.current_state >= STATE_MAX) {
+        return STATUS_ERROR_INVALID_STATE;
+    }
+
+    log_event(event);
+
+    fsm_during_t during = during_table[machine.current_state];
+    if (during) {
+        event = during(event);
+    }
+
+    /* The whole dispatch: one indexed lookup */
+    const fsm_transition_t *t = &transition_table[machine.current_state][event];
+    if (!t->handled || (t->guard && !t->guard())) {
+        return STATUS_OK;
+    }
+
+    return fsm_transition(t);
+}
+
+/* ============================================================================
+ * REFERENCE: SWITCH DISPATCH FROM 04_production.c
+ * ============================================================================
+ * Kept verbatim (apart from the history fix noted below) so the two can be
+ * compared event-for-event and timed on the same input.
+ */
+
+static status_t switch_transition(wash_state_t new_state) {
+    status_t status;
+    wash_state_t old_state = machine.current_state;
+
+    if (new_state >= STATE_MAX) {
+        log_error("Invalid state transition");
+        return STATUS_ERROR_INVALID_STATE;
+    }
+
+    switch (old_state) {
+        case STATE_FILLING:  status = on_exit_filling();  break;
+        case STATE_WASHING:  status = on_exit_washing();  break;
+        case STATE_DRAINING: status = on_exit_draining(); break;
+        case STATE_SPINNING: status = on_exit_spinning(); break;
+        default:             status = STATUS_OK;          break;
+    }
+
+    if (status != STATUS_OK) {
+        log_error("Exit action failed");
+        return status;
+    }
+
+    /*
+     * 04_production.c saves history in on_enter_paused(), after
+     * current_state already became PAUSED, so RESUME returns to PAUSED.
+     * Saved here instead so both versions agree.
+     */
+    if (new_state == STATE_PAUSED) {
+        machine.previous_state = old_state;
+    }
+
+    machine.current_state = new_state;
+    machine.state_entry_time = 0;
+    log_state_change(old_state, new_state);
+
+    switch (new_state) {
+        case STATE_IDLE:     status = on_enter_idle();     break;
+        case STATE_FILLING:  status = on_enter_filling();  break;
+        case STATE_WASHING:  status = on_enter_washing();  break;
+        case STATE_DRAINING: status = on_enter_draining(); break;
+        case STATE_SPINNING: status = on_enter_spinning(); break;
+        case STATE_DONE:     status = on_enter_done();     break;
+        case STATE_PAUSED:   status = on_enter_paused();   break;
+        case STATE_ERROR:    status = on_enter_error();    break;
+        default:             status = STATUS_ERROR_INVALID_STATE; break;
+    }
+
+    if (status != STATUS_OK) {
+        log_error("Entry action failed");
+        machine.current_state = STATE_ERROR;
+        on_enter_error();
+    }
+
+    return status;
+}
+
+static status_t switch_run(wash_event_t event) {
+    if (event >= EVENT_MAX) {
+        return STATUS_ERROR_INVALID_EVENT;
+    }
+
+    log_event(event);
+
+    switch (machine.current_state) {
+        case STATE_IDLE:
+            if (event == EVENT_START && !machine.door_open) {
+                return switch_transition(STATE_FILLING);
+            }
+            break;
+
+        case STATE_FILLING:
+            if (event == EVENT_WATER_FULL) {
+                return switch_transition(STATE_WASHING);
+            } else if (event == EVENT_PAUSE) {
+                return switch_transition(STATE_PAUSED);
+            } else if (event == EVENT_ERROR) {
+                return switch_transition(STATE_ERROR);
+            } else if (event == EVENT_STOP) {
+                return switch_transition(STATE_DRAINING);
+            }
+            break;
+
+        case STATE_WASHING:
+            if (machine.wash_timer > 0) {
+                machine.wash_timer--;
+            }
+            if (event == EVENT_WASH_DONE || machine.wash_timer == 0) {
+                return switch_transition(STATE_DRAINING);
+            } else if (event == EVENT_PAUSE) {
+                return switch_transition(STATE_PAUSED);
+            } else if (event == EVENT_ERROR) {
+                return switch_transition(STATE_ERROR);
+            }
+            break;
+
+        case STATE_DRAINING:
+            if (event == EVENT_DRAIN_DONE) {
+                return switch_transition(STATE_SPINNING);
+            } else if (event == EVENT_ERROR) {
+                return switch_transition(STATE_ERROR);
+            }
+            break;
+
+        case STATE_SPINNING:
+            if (machine.spin_timer > 0) {
+                machine.spin_timer--;
+            }
+            if (event == EVENT_SPIN_DONE || machine.spin_timer == 0) {
+                return switch_transition(STATE_DONE);
+            } else if (event == EVENT_ERROR) {
+                return switch_transition(STATE_ERROR);
+            }
+            break;
+
+        case STATE_DONE:
+            if (event == EVENT_START && !machine.door_open) {
+                return switch_transition(STATE_FILLING);
+            }
+            break;
+
+        case STATE_PAUSED:
+            if (event == EVENT_RESUME) {
+                return switch_transition(machine.previous_state);
+            } else if (event == EVENT_STOP) {
+                return switch_transition(STATE_IDLE);
+            }
+            break;
+
+        case STATE_ERROR:
+            if (event == EVENT_RESET) {
+                machine.error_count = 0;
+                return switch_transition(STATE_IDLE);
+            }
+            break;
+
+        default:
+            return STATUS_ERROR_INVALID_STATE;
+    }
+
+    return STATUS_OK;
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+status_t wash_machine_init(wash_program_t program) {
+    memset(&machine, 0, sizeof(machine));
+    machine.current_state = STATE_IDLE;
+    machine.program = program;
+    machine.initialized = true;
+    LOG("[INIT] Washing machine initialized with program: %d\n", program);
+    return STATUS_OK;
+}
+
+/* ============================================================================
+ * EQUIVALENCE CHECK AND BENCHMARK
+ * ============================================================================ */
+
+#define BENCH_EVENTS 1000000
+#define BENCH_PASSES 20
+
+static wash_event_t bench_events[BENCH_EVENTS];
+
+/* Mostly ticks, with a realistic sprinkling of every other event */
+static void make_event_stream(void) {
+    uint32_t seed = 12345;
+    for (int i = 0; i < BENCH_EVENTS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t r = (seed >> 16) % 100;
+        bench_events[i] = (r < 70) ? EVENT_NONE : (wash_event_t)(r % EVENT_NONE);
+    }
+}
+
+static bool check_equivalence(void) {
+    static wash_state_t table_trace[BENCH_EVENTS / 10];
+    int n = BENCH_EVENTS / 10;
+
+    wash_machine_init(PROGRAM_QUICK);
+    for (int i = 0; i < n; i++) {
+        state_machine_run(bench_events[i]);
+        table_trace[i] = machine.current_state;
+    }
+
+    wash_machine_init(PROGRAM_QUICK);
+    for (int i = 0; i < n; i++) {
+        switch_run(bench_events[i]);
+        if (machine.current_state != table_trace[i]) {
+            printf("Mismatch at event %d (%s): switch=%s table=%s\n",
+                   i, event_names[bench_events[i]],
+                   state_names[machine.current_state], state_names[table_trace[i]]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static double bench(status_t (*run)(wash_event_t)) {
+    struct timespec start, end;
+    wash_machine_init(PROGRAM_QUICK);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int p = 0; p < BENCH_PASSES; p++) {
+        for (int i = 0; i < BENCH_EVENTS; i++) {
+            run(bench_events[i]);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    return ns / ((double)BENCH_EVENTS * BENCH_PASSES);
+}
+
+int main(void) {
+    printf("=== Table-Driven State Machine Engine ===\n\n");
+
+    wash_machine_init(PROGRAM_NORMAL);
+
+    printf("\n--- Starting wash cycle ---\n");
+    state_machine_run(EVENT_START);
+    for (int i = 0; i < 5; i++) {
+        state_machine_run(EVENT_NONE);
+    }
+    state_machine_run(EVENT_WATER_FULL);
+    state_machine_run(EVENT_PAUSE);
+    state_machine_run(EVENT_RESUME);
+    for (int i = 0; i < 30; i++) {
+        state_machine_run(EVENT_NONE);
+    }
+    state_machine_run(EVENT_DRAIN_DONE);
+    for (int i = 0; i < 20; i++) {
+        state_machine_run(EVENT_NONE);
+    }
+
+    printf("\n=== Table Size ===\n");
+    printf("transition_table: %zu bytes (const, in flash)\n", sizeof(transition_table));
+    printf("entry/exit/during tables: %zu bytes\n",
+           sizeof(entry_table) + sizeof(exit_table) + sizeof(during_table));
+
+    quiet = true;
+    make_event_stream();
+
+    printf("\n=== Equivalence (first %d events) ===\n", BENCH_EVENTS / 10);
+    printf("%s\n", check_equivalence() ? "✅ Table and switch versions agree"
+                                       : "❌ Versions diverge");
+
+    printf("\n=== Dispatch Cost (%d x %d events, logging off) ===\n",
+           BENCH_PASSES, BENCH_EVENTS);
+    double t_switch = bench(switch_run);
+    double t_table = bench(state_machine_run);
+    printf("Switch dispatch: %.2f ns/event\n", t_switch);
+    printf("Table dispatch:  %.2f ns/event\n", t_table);
+    if (t_table < t_switch) {
+        printf("✅ Table is %.2fx FASTER\n", t_switch / t_table);
+    } else {
+        printf("❌ Switch is %.2fx faster\n", t_table / t_switch);
+        printf("   With 8 states the compiler turns the switch into a jump\n");
+        printf("   table and inlines every action; the engine pays for\n");
+        printf("   indirect calls. The table's win is flat cost as the\n");
+        printf("   machine grows, and that logging was the real bottleneck.\n");
+    }
+
+    printf("\n=== Engine Features ===\n");
+    printf("1. One [state][event] lookup per dispatch\n");
+    printf("2. Guards and transition actions in the table\n");
+    printf("3. Entry/exit/during function-pointer tables\n");
+    printf("4. History pseudo-state for PAUSE/RESUME\n");
+    printf("5. Same validation and error handling as 04_production.c\n");
+
+    return 0;
+}
+
+/*
+ * TABLE-DRIVEN ENGINE NOTES:
+ *
+ * 1. MEMORY
+ *    - STATE_MAX x EVENT_MAX cells, mostly empty
+ *    - Const tables go to flash; only wash_machine_t is RAM
+ *
+ * 2. SPEED
+ *    - No compare chains: cost does not grow with states/events
+ *    - Biggest remaining cost is logging (see 04_production.c)
+ *
+ * 3. MAINTAINABILITY
+ *    - Adding a transition = adding one table cell
+ *    - The table reads like the state diagram
+ *    - Guards and actions are small named functions
+ *
+ * 4. LIMITS
+ *    - One cell per (state, event): conditional targets need
+ *      a guard or a during-action
+ *    - Dense table wastes space when EVENT_MAX is large
+ */
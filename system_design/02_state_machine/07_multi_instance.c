@@ -0,0 +1,624 @@
+/**
+ * 07_multi_instance.c - Many State Machine Instances, One Engine
+ *
+ * 06_table_driven.c still drives ONE machine: a static global that every
+ * action touches implicitly. A fleet simulator needs 100,000 of them.
+ * This version:
+ * - Passes the instance pointer to every guard/action (no globals)
+ * - Packs each instance into 12 bytes, stored in one contiguous array
+ * - Processes batches of (instance, event) pairs
+ * - Optionally shards a batch across worker threads by instance id
+ * - Measures events/second for 1..N cores
+ *
+ * The transition table is shared and const; only instance data differs.
+ *
+ * Compile: gcc -O2 -std=c11 -pthread 07_multi_instance.c -o multi_instance
+ * Run:     ./multi_instance
+ *
+ * Study time: 25 minutes
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+typedef enum {
+    STATUS_OK = 0,
+    STATUS_ERROR_INVALID_STATE,
+    STATUS_ERROR_INVALID_EVENT,
+    STATUS_ERROR_DOOR_OPEN,
+    STATUS_ERROR_HARDWARE,
+    STATUS_ERROR_INVALID_PARAM
+} status_t;
+
+/* ============================================================================
+ * STATE MACHINE DEFINITION (same as 06_table_driven.c)
+ * ============================================================================ */
+
+typedef enum {
+    STATE_IDLE,
+    STATE_FILLING,
+    STATE_WASHING,
+    STATE_DRAINING,
+    STATE_SPINNING,
+    STATE_DONE,
+    STATE_PAUSED,
+    STATE_ERROR,
+    STATE_MAX,
+    STATE_HISTORY = STATE_MAX
+} wash_state_t;
+
+typedef enum {
+    EVENT_START,
+    EVENT_WATER_FULL,
+    EVENT_WASH_DONE,
+    EVENT_DRAIN_DONE,
+    EVENT_SPIN_DONE,
+    EVENT_PAUSE,
+    EVENT_RESUME,
+    EVENT_STOP,
+    EVENT_ERROR,
+    EVENT_RESET,
+    EVENT_NONE,
+    EVENT_MAX
+} wash_event_t;
+
+typedef enum {
+    PROGRAM_NORMAL,
+    PROGRAM_DELICATE,
+    PROGRAM_HEAVY,
+    PROGRAM_QUICK
+} wash_program_t;
+
+typedef struct {
+    uint16_t fill_time;
+    uint16_t wash_time;
+    uint16_t spin_time;
+    uint8_t motor_speed;
+} program_config_t;
+
+static const program_config_t programs[] = {
+    [PROGRAM_NORMAL]   = {10, 30, 20, 100},
+    [PROGRAM_DELICATE] = {10, 20, 10, 50},
+    [PROGRAM_HEAVY]    = {15, 45, 30, 100},
+    [PROGRAM_QUICK]    = {5,  15, 10, 100}
+};
+
+const char* state_names[] = {
+    "IDLE", "FILLING", "WASHING", "DRAINING",
+    "SPINNING", "DONE", "PAUSED", "ERROR"
+};
+
+/*
+ * Compact per-instance context. Enums are stored as uint8_t and timers
+ * as uint16_t (longest program phase is 45 ticks): 12 bytes instead of
+ * the original 32, so 5 instances share a 64-byte cache line, not 2.
+ */
+typedef struct {
+    uint8_t  current_state;
+    uint8_t  previous_state;
+    uint8_t  program;
+    uint8_t  door_open;
+    uint16_t wash_timer;
+    uint16_t spin_timer;
+    uint16_t error_count;
+    uint16_t transitions;    /* Per-instance diagnostics (wraps) */
+} wash_machine_t;
+
+/* ============================================================================
+ * HARDWARE ABSTRACTION (per instance, simulated)
+ * ============================================================================
+ * A real fleet simulator would drive a model of each machine here; we only
+ * need the calls to exist so the dispatch cost is realistic.
+ */
+
+static inline status_t hw_lock_door(wash_machine_t *m)         { (void)m; return STATUS_OK; }
+static inline status_t hw_unlock_door(wash_machine_t *m)       { (void)m; return STATUS_OK; }
+static inline status_t hw_open_water_valve(wash_machine_t *m)  { (void)m; return STATUS_OK; }
+static inline status_t hw_close_water_valve(wash_machine_t *m) { (void)m; return STATUS_OK; }
+static inline status_t hw_start_motor(wash_machine_t *m, uint8_t speed) { (void)m; (void)speed; return STATUS_OK; }
+static inline status_t hw_stop_motor(wash_machine_t *m)        { (void)m; return STATUS_OK; }
+static inline status_t hw_open_drain_valve(wash_machine_t *m)  { (void)m; return STATUS_OK; }
+static inline status_t hw_close_drain_valve(wash_machine_t *m) { (void)m; return STATUS_OK; }
+static inline void     hw_beep(wash_machine_t *m, uint8_t count) { (void)m; (void)count; }
+
+/* ============================================================================
+ * STATE ACTIONS (instance pointer instead of the global)
+ * ============================================================================ */
+
+static status_t on_enter_idle(wash_machine_t *m) {
+    hw_unlock_door(m);
+    m->wash_timer = 0;
+    m->spin_timer = 0;
+    return STATUS_OK;
+}
+
+static status_t on_enter_filling(wash_machine_t *m) {
+    status_t status;
+
+    if (m->door_open) {
+        m->error_count++;
+        return STATUS_ERROR_DOOR_OPEN;
+    }
+
+    status = hw_lock_door(m);
+    if (status != STATUS_OK) return status;
+
+    return hw_open_water_valve(m);
+}
+
+static status_t on_exit_filling(wash_machine_t *m) {
+    return hw_close_water_valve(m);
+}
+
+static status_t on_enter_washing(wash_machine_t *m) {
+    const program_config_t *config = &programs[m->program];
+    m->wash_timer = config->wash_time;
+    return hw_start_motor(m, config->motor_speed);
+}
+
+static status_t on_exit_washing(wash_machine_t *m) {
+    return hw_stop_motor(m);
+}
+
+static status_t on_enter_draining(wash_machine_t *m) {
+    return hw_open_drain_valve(m);
+}
+
+static status_t on_exit_draining(wash_machine_t *m) {
+    return hw_close_drain_valve(m);
+}
+
+static status_t on_enter_spinning(wash_machine_t *m) {
+    m->spin_timer = programs[m->program].spin_time;
+    return hw_start_motor(m, 100);
+}
+
+static status_t on_exit_spinning(wash_machine_t *m) {
+    return hw_stop_motor(m);
+}
+
+static status_t on_enter_done(wash_machine_t *m) {
+    hw_unlock_door(m);
+    hw_beep(m, 3);
+    return STATUS_OK;
+}
+
+static status_t on_enter_paused(wash_machine_t *m) {
+    hw_stop_motor(m);
+    hw_close_water_valve(m);
+    return STATUS_OK;
+}
+
+static status_t on_enter_error(wash_machine_t *m) {
+    hw_stop_motor(m);
+    hw_close_water_valve(m);
+    hw_close_drain_valve(m);
+    hw_beep(m, 5);
+    return STATUS_OK;
+}
+
+static bool guard_door_closed(wash_machine_t *m) {
+    return !m->door_open;
+}
+
+static status_t action_save_history(wash_machine_t *m) {
+    m->previous_state = m->current_state;
+    return STATUS_OK;
+}
+
+static status_t action_clear_errors(wash_machine_t *m) {
+    m->error_count = 0;
+    return STATUS_OK;
+}
+
+static wash_event_t during_washing(wash_machine_t *m, wash_event_t event) {
+    if (m->wash_timer > 0) {
+        m->wash_timer--;
+    }
+    return (m->wash_timer == 0) ? EVENT_WASH_DONE : event;
+}
+
+static wash_event_t during_spinning(wash_machine_t *m, wash_event_t event) {
+    if (m->spin_timer > 0) {
+        m->spin_timer--;
+    }
+    return (m->spin_timer == 0) ? EVENT_SPIN_DONE : event;
+}
+
+/* ============================================================================
+ * ENGINE (06_table_driven.c with an instance parameter)
+ * ============================================================================ */
+
+typedef bool (*fsm_guard_t)(wash_machine_t *m);
+typedef status_t (*fsm_action_t)(wash_machine_t *m);
+typedef wash_event_t (*fsm_during_t)(wash_machine_t *m, wash_event_t event);
+
+typedef struct {
+    fsm_guard_t  guard;
+    fsm_action_t action;
+    uint8_t      target;
+    bool         handled;
+} fsm_transition_t;
+
+#define T(to, g, a)  { .guard = (g), .action = (a), .target = (to), .handled = true }
+
+static const fsm_transition_t transition_table[STATE_MAX][EVENT_MAX] = {
+    [STATE_IDLE] = {
+        [EVENT_START]      = T(STATE_FILLING,  guard_door_closed, NULL),
+    },
+    [STATE_FILLING] = {
+        [EVENT_WATER_FULL] = T(STATE_WASHING,  NULL, NULL),
+        [EVENT_PAUSE]      = T(STATE_PAUSED,   NULL, action_save_history),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+        [EVENT_STOP]       = T(STATE_DRAINING, NULL, NULL),
+    },
+    [STATE_WASHING] = {
+        [EVENT_WASH_DONE]  = T(STATE_DRAINING, NULL, NULL),
+        [EVENT_PAUSE]      = T(STATE_PAUSED,   NULL, action_save_history),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+    },
+    [STATE_DRAINING] = {
+        [EVENT_DRAIN_DONE] = T(STATE_SPINNING, NULL, NULL),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+    },
+    [STATE_SPINNING] = {
+        [EVENT_SPIN_DONE]  = T(STATE_DONE,     NULL, NULL),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+    },
+    [STATE_DONE] = {
+        [EVENT_START]      = T(STATE_FILLING,  guard_door_closed, NULL),
+    },
+    [STATE_PAUSED] = {
+        [EVENT_RESUME]     = T(STATE_HISTORY,  NULL, NULL),
+        [EVENT_STOP]       = T(STATE_IDLE,     NULL, NULL),
+    },
+    [STATE_ERROR] = {
+        [EVENT_RESET]      = T(STATE_IDLE,     NULL, action_clear_errors),
+    },
+};
+
+static const fsm_action_t entry_table[STATE_MAX] = {
+    [STATE_IDLE]     = on_enter_idle,
+    [STATE_FILLING]  = on_enter_filling,
+    [STATE_WASHING]  = on_enter_washing,
+    [STATE_DRAINING] = on_enter_draining,
+    [STATE_SPINNING] = on_enter_spinning,
+    [STATE_DONE]     = on_enter_done,
+    [STATE_PAUSED]   = on_enter_paused,
+    [STATE_ERROR]    = on_enter_error,
+};
+
+static const fsm_action_t exit_table[STATE_MAX] = {
+    [STATE_FILLING]  = on_exit_filling,
+    [STATE_WASHING]  = on_exit_washing,
+    [STATE_DRAINING] = on_exit_draining,
+    [STATE_SPINNING] = on_exit_spinning,
+};
+
+static const fsm_during_t during_table[STATE_MAX] = {
+    [STATE_WASHING]  = during_washing,
+    [STATE_SPINNING] = during_spinning,
+};
+
+static status_t fsm_transition(wash_machine_t *m, const fsm_transition_t *t) {
+    wash_state_t old_state = m->current_state;
+    wash_state_t new_state = (t->target == STATE_HISTORY)
+                             ? (wash_state_t)m->previous_state : (wash_state_t)t->target;
+    status_t status;
+
+    if (exit_table[old_state]) {
+        status = exit_table[old_state](m);
+        if (status != STATUS_OK) {
+            m->error_count++;
+            return status;
+        }
+    }
+
+    if (t->action) {
+        status = t->action(m);
+        if (status != STATUS_OK) {
+            m->error_count++;
+            return status;
+        }
+    }
+
+    m->current_state = new_state;
+    m->transitions++;
+
+    status = entry_table[new_state](m);
+    if (status != STATUS_OK) {
+        m->current_state = STATE_ERROR;
+        on_enter_error(m);
+    }
+
+    return status;
+}
+
+static status_t fsm_dispatch(wash_machine_t *m, wash_event_t event) {
+    if (event >= EVENT_MAX) {
+        return STATUS_ERROR_INVALID_EVENT;
+    }
+    if (m->current_state >= STATE_MAX) {
+        return STATUS_ERROR_INVALID_STATE;
+    }
+
+    fsm_during_t during = during_table[m->current_state];
+    if (during) {
+        event = during(m, event);
+    }
+
+    const fsm_transition_t *t = &transition_table[m->current_state][event];
+    if (!t->handled || (t->guard && !t->guard(m))) {
+        return STATUS_OK;
+    }
+
+    return fsm_transition(m, t);
+}
+
+/* ============================================================================
+ * FLEET AND BATCH PROCESSING
+ * ============================================================================ */
+
+#define FLEET_SIZE   100000
+#define MAX_WORKERS  64
+
+static wash_machine_t fleet[FLEET_SIZE];
+
+typedef struct {
+    uint32_t instance;
+    uint32_t event;
+} fsm_batch_entry_t;
+
+static void fleet_init(void) {
+    for (uint32_t i = 0; i < FLEET_SIZE; i++) {
+        memset(&fleet[i], 0, sizeof(fleet[i]));
+        fleet[i].current_state = STATE_IDLE;
+        fleet[i].program = i % 4;
+    }
+}
+
+/*
+ * Sequential: apply every entry in order. An out-of-range instance is
+ * skipped (the rest of the batch still runs) and reported at the end.
+ */
+static status_t fsm_process_batch(wash_machine_t *machines, const fsm_batch_entry_t *batch,
+                                  uint32_t count) {
+    status_t status = STATUS_OK;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (batch[i].instance >= FLEET_SIZE) {
+            status = STATUS_ERROR_INVALID_PARAM;
+            continue;
+        }
+        fsm_dispatch(&machines[batch[i].instance], (wash_event_t)batch[i].event);
+    }
+    return status;
+}
+
+/*
+ * Sharding. Each worker owns a contiguous RANGE of instance ids, so:
+ * - No locks: an instance is only ever touched by its owner
+ * - Per-instance event order is preserved
+ * - No false sharing: neighbours in memory have the same owner
+ *   (id % workers would put 5 owners on every cache line)
+ */
+/* instance must be < FLEET_SIZE (fsm_batch_shard checks before calling) */
+static inline uint32_t shard_of(uint32_t instance, uint32_t num_shards) {
+    return (uint32_t)(((uint64_t)instance * num_shards) / FLEET_SIZE);
+}
+
+/*
+ * Stable counting sort of a batch into per-shard runs. This is the
+ * producer's job (done once per batch), so the workers never scan
+ * entries they don't own.
+ */
+static status_t fsm_batch_shard(const fsm_batch_entry_t *in, fsm_batch_entry_t *out,
+                                uint32_t count, uint32_t num_shards,
+                                uint32_t offsets[MAX_WORKERS + 1]) {
+    uint32_t fill[MAX_WORKERS] = {0};
+
+    if (num_shards == 0 || num_shards > MAX_WORKERS) {
+        return STATUS_ERROR_INVALID_PARAM;
+    }
+
+    /* Reject the whole batch up front: a bad id would index past offsets[] */
+    for (uint32_t i = 0; i < count; i++) {
+        if (in[i].instance >= FLEET_SIZE) {
+            return STATUS_ERROR_INVALID_PARAM;
+        }
+    }
+
+    memset(offsets, 0, sizeof(uint32_t) * (MAX_WORKERS + 1));
+    for (uint32_t i = 0; i < count; i++) {
+        offsets[shard_of(in[i].instance, num_shards) + 1]++;
+    }
+    for (uint32_t s = 0; s < num_shards; s++) {
+        offsets[s + 1] += offsets[s];
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t s = shard_of(in[i].instance, num_shards);
+        out[offsets[s] + fill[s]++] = in[i];
+    }
+    return STATUS_OK;
+}
+
+typedef struct {
+    const fsm_batch_entry_t *entries;
+    uint32_t count;
+    uint32_t passes;
+} worker_arg_t;
+
+static void* batch_worker(void *arg) {
+    worker_arg_t *w = arg;
+    for (uint32_t p = 0; p < w->passes; p++) {
+        fsm_process_batch(fleet, w->entries, w->count);
+    }
+    return NULL;
+}
+
+/* Parallel: one thread per shard, each runs its own run of the batch */
+static void fsm_process_batch_parallel(const fsm_batch_entry_t *sharded,
+                                       const uint32_t *offsets,
+                                       uint32_t num_shards, uint32_t passes) {
+    pthread_t threads[MAX_WORKERS];
+    worker_arg_t args[MAX_WORKERS];
+
+    for (uint32_t s = 0; s < num_shards; s++) {
+        args[s].entries = &sharded[offsets[s]];
+        args[s].count = offsets[s + 1] - offsets[s];
+        args[s].passes = passes;
+        pthread_create(&threads[s], NULL, batch_worker, &args[s]);
+    }
+    for (uint32_t s = 0; s < num_shards; s++) {
+        pthread_join(threads[s], NULL);
+    }
+}
+
+/* ============================================================================
+ * BENCHMARK
+ * ============================================================================ */
+
+#define BATCH_SIZE   (1u << 20)
+#define BENCH_PASSES 10
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Random instances, mostly ticks, some of every other event */
+static void make_batch(fsm_batch_entry_t *batch) {
+    uint32_t seed = 12345;
+    for (uint32_t i = 0; i < BATCH_SIZE; i++) {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t r = seed >> 8;
+        batch[i].instance = r % FLEET_SIZE;
+        uint32_t kind = (seed >> 4) % 100;
+        batch[i].event = (kind < 70) ? EVENT_NONE : kind % EVENT_NONE;
+    }
+}
+
+static void print_state_histogram(void) {
+    uint32_t counts[STATE_MAX] = {0};
+    for (uint32_t i = 0; i < FLEET_SIZE; i++) {
+        counts[fleet[i].current_state]++;
+    }
+    for (int s = 0; s < STATE_MAX; s++) {
+        printf("  %-9s %6u\n", state_names[s], counts[s]);
+    }
+}
+
+int main(void) {
+    printf("=== Multi-Instance State Machine Engine ===\n\n");
+
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu < 1) ncpu = 1;
+    if (ncpu > MAX_WORKERS) ncpu = MAX_WORKERS;
+
+    printf("Instances:       %u\n", FLEET_SIZE);
+    printf("Instance size:   %zu bytes\n", sizeof(wash_machine_t));
+    printf("Fleet memory:    %zu KB (one contiguous array)\n", sizeof(fleet) / 1024);
+    printf("Batch:           %u (instance, event) pairs\n", BATCH_SIZE);
+    printf("Online CPUs:     %ld\n\n", ncpu);
+
+    fsm_batch_entry_t *batch = malloc(sizeof(*batch) * BATCH_SIZE);
+    fsm_batch_entry_t *sharded = malloc(sizeof(*sharded) * BATCH_SIZE);
+    if (!batch || !sharded) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    make_batch(batch);
+
+    /* Sequential run: also the reference for the parallel result */
+    fleet_init();
+    if (fsm_process_batch(fleet, batch, BATCH_SIZE) != STATUS_OK) {
+        printf("Batch contains out-of-range instances\n");
+        return 1;
+    }
+    printf("Fleet after one batch (sequential):\n");
+    print_state_histogram();
+
+    static wash_machine_t reference[FLEET_SIZE];
+    memcpy(reference, fleet, sizeof(fleet));
+
+    /* Sharding must give exactly the same per-instance result */
+    uint32_t offsets[MAX_WORKERS + 1];
+    uint32_t check_shards = (ncpu > 1) ? (uint32_t)ncpu : 4;
+    fleet_init();
+    if (fsm_batch_shard(batch, sharded, BATCH_SIZE, check_shards, offsets) != STATUS_OK) {
+        printf("Cannot shard batch\n");
+        return 1;
+    }
+    fsm_process_batch_parallel(sharded, offsets, check_shards, 1);
+    printf("\nSharded (%u workers) matches sequential: %s\n", check_shards,
+           memcmp(reference, fleet, sizeof(fleet)) == 0 ? "✅ yes" : "❌ NO");
+
+    printf("\n=== Throughput (%d passes over the batch) ===\n", BENCH_PASSES);
+    printf("%-8s %14s %12s %12s\n", "Workers", "Events/s", "Speedup", "Shard ms");
+
+    double base = 0;
+    uint32_t workers = 1;
+    for (;;) {
+        fleet_init();
+
+        double t0 = now_sec();
+        if (fsm_batch_shard(batch, sharded, BATCH_SIZE, workers, offsets) != STATUS_OK) {
+            printf("Cannot shard batch for %u workers\n", workers);
+            break;
+        }
+        double t1 = now_sec();
+        fsm_process_batch_parallel(sharded, offsets, workers, BENCH_PASSES);
+        double t2 = now_sec();
+
+        double eps = (double)BATCH_SIZE * BENCH_PASSES / (t2 - t1);
+        if (workers == 1) base = eps;
+        printf("%-8u %14.0f %11.2fx %12.2f\n", workers, eps, eps / base,
+               (t1 - t0) * 1000);
+
+        /* 1, 2, 4, ... and always finish on exactly the CPU count */
+        if (workers == (uint32_t)ncpu) break;
+        workers = (workers * 2 > (uint32_t)ncpu) ? (uint32_t)ncpu : workers * 2;
+    }
+
+    free(batch);
+    free(sharded);
+
+    printf("\n=== Multi-Instance Features ===\n");
+    printf("1. Instance pointer passed to every action\n");
+    printf("2. %zu-byte instances in one contiguous array\n", sizeof(wash_machine_t));
+    printf("3. Shared const transition table\n");
+    printf("4. Batch API: (instance, event) pairs\n");
+    printf("5. Range sharding: lock-free, order-preserving\n");
+
+    return 0;
+}
+
+/*
+ * MULTI-INSTANCE NOTES:
+ *
+ * 1. MEMORY
+ *    - 100k x 12 bytes = ~1.2 MB, fits in L2/L3 on most servers
+ *    - Tables are shared: adding instances costs only instance data
+ *
+ * 2. SCALING
+ *    - No shared writes between workers = near-linear speedup
+ *    - Random instance order makes each event a cache miss;
+ *      sorting a batch by instance would help further
+ *
+ * 3. ORDERING
+ *    - Order is preserved per instance, not across instances
+ *    - That is all a state machine needs
+ *
+ * 4. ON A REAL MCU
+ *    - Same engine drives e.g. 4 motor channels or 32 UART ports
+ *    - Replace threads with one loop over the instance array
+ */
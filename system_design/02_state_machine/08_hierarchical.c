@@ -0,0 +1,618 @@
+/**
+ * 08_hierarchical.c - Hierarchical State Machine (Superstates)
+ *
+ * In the flat table of 06_table_driven.c, FILLING, WASHING, DRAINING and
+ * SPINNING each repeat the same cells for EVENT_ERROR, and FILLING and
+ * WASHING repeat EVENT_PAUSE. This version adds superstates:
+ *
+ *   IDLE
+ *   RUNNING                 ERROR -> ERROR
+ *   ├── WET                 PAUSE -> PAUSED, STOP -> DRAINING
+ *   │   ├── FILLING         WATER_FULL -> WASHING
+ *   │   └── WASHING         WASH_DONE  -> DRAINING
+ *   ├── DRAINING            DRAIN_DONE -> SPINNING
+ *   └── SPINNING            SPIN_DONE  -> DONE, ERROR -> ERROR (override:
+ *                                         brake the drum first)
+ *   DONE
+ *   PAUSED
+ *   ERROR
+ *
+ * - A child that does not handle an event passes it to its parent
+ * - A child can override a parent's transition
+ * - Exit/entry chains follow the least common ancestor (LCA), which is
+ *   precomputed once for every (state, target) pair
+ * - Dispatch is O(depth): at most 3 table lookups here, no searching
+ *
+ * Note: WASHING now inherits STOP -> DRAINING from WET (it ignored STOP
+ * in 04_production.c).
+ *
+ * Compile: gcc -std=c11 08_hierarchical.c -o hierarchical
+ * Run:     ./hierarchical
+ *
+ * Study time: 30 minutes
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef enum {
+    STATUS_OK = 0,
+    STATUS_ERROR_INVALID_STATE,
+    STATUS_ERROR_INVALID_EVENT,
+    STATUS_ERROR_DOOR_OPEN,
+    STATUS_ERROR_HARDWARE
+} status_t;
+
+/* ============================================================================
+ * STATE MACHINE DEFINITION
+ * ============================================================================ */
+
+typedef enum {
+    /* Leaf states (same values as 04_production.c) */
+    STATE_IDLE,
+    STATE_FILLING,
+    STATE_WASHING,
+    STATE_DRAINING,
+    STATE_SPINNING,
+    STATE_DONE,
+    STATE_PAUSED,
+    STATE_ERROR,
+    /* Superstates: never "current", only handle events */
+    STATE_RUNNING,
+    STATE_WET,
+    STATE_MAX,
+    STATE_HISTORY = STATE_MAX,   /* Pseudo-target: previous leaf */
+    STATE_NONE    = 0xFF         /* "No parent" / "no initial child" */
+} wash_state_t;
+
+typedef enum {
+    EVENT_START,
+    EVENT_WATER_FULL,
+    EVENT_WASH_DONE,
+    EVENT_DRAIN_DONE,
+    EVENT_SPIN_DONE,
+    EVENT_PAUSE,
+    EVENT_RESUME,
+    EVENT_STOP,
+    EVENT_ERROR,
+    EVENT_RESET,
+    EVENT_NONE,
+    EVENT_MAX
+} wash_event_t;
+
+typedef enum {
+    PROGRAM_NORMAL,
+    PROGRAM_DELICATE,
+    PROGRAM_HEAVY,
+    PROGRAM_QUICK
+} wash_program_t;
+
+typedef struct {
+    uint16_t fill_time;
+    uint16_t wash_time;
+    uint16_t spin_time;
+    uint8_t motor_speed;
+} program_config_t;
+
+static const program_config_t programs[] = {
+    [PROGRAM_NORMAL]   = {10, 30, 20, 100},
+    [PROGRAM_DELICATE] = {10, 20, 10, 50},
+    [PROGRAM_HEAVY]    = {15, 45, 30, 100},
+    [PROGRAM_QUICK]    = {5,  15, 10, 100}
+};
+
+const char* state_names[] = {
+    "IDLE", "FILLING", "WASHING", "DRAINING",
+    "SPINNING", "DONE", "PAUSED", "ERROR",
+    "RUNNING", "WET"
+};
+
+const char* event_names[] = {
+    "START", "WATER_FULL", "WASH_DONE", "DRAIN_DONE",
+    "SPIN_DONE", "PAUSE", "RESUME", "STOP",
+    "ERROR", "RESET", "NONE"
+};
+
+/* Per-instance context (07_multi_instance.c layout) */
+typedef struct {
+    uint8_t  current_state;   /* Always a leaf */
+    uint8_t  previous_state;  /* Leaf to RESUME into */
+    uint8_t  program;
+    uint8_t  door_open;
+    uint16_t wash_timer;
+    uint16_t spin_timer;
+    uint16_t error_count;
+    uint16_t transitions;
+} wash_machine_t;
+
+/* ============================================================================
+ * HARDWARE ABSTRACTION (simulated)
+ * ============================================================================ */
+
+static status_t hw_lock_door(wash_machine_t *m)         { (void)m; printf("  [HW] Door locked\n");        return STATUS_OK; }
+static status_t hw_unlock_door(wash_machine_t *m)       { (void)m; printf("  [HW] Door unlocked\n");      return STATUS_OK; }
+static status_t hw_open_water_valve(wash_machine_t *m)  { (void)m; printf("  [HW] Water valve open\n");   return STATUS_OK; }
+static status_t hw_close_water_valve(wash_machine_t *m) { (void)m; printf("  [HW] Water valve closed\n"); return STATUS_OK; }
+static status_t hw_stop_motor(wash_machine_t *m)        { (void)m; printf("  [HW] Motor stopped\n");      return STATUS_OK; }
+static status_t hw_open_drain_valve(wash_machine_t *m)  { (void)m; printf("  [HW] Drain valve open\n");   return STATUS_OK; }
+static status_t hw_close_drain_valve(wash_machine_t *m) { (void)m; printf("  [HW] Drain valve closed\n"); return STATUS_OK; }
+static status_t hw_brake_drum(wash_machine_t *m)        { (void)m; printf("  [HW] Drum brake engaged\n"); return STATUS_OK; }
+
+static status_t hw_start_motor(wash_machine_t *m, uint8_t speed) {
+    (void)m;
+    printf("  [HW] Motor at %d%% speed\n", speed);
+    return STATUS_OK;
+}
+
+static void hw_beep(wash_machine_t *m, uint8_t count) {
+    (void)m;
+    printf("  [HW] BEEP! (%d times)\n", count);
+}
+
+/* ============================================================================
+ * ENTRY/EXIT ACTIONS
+ * ============================================================================ */
+
+static status_t on_enter_idle(wash_machine_t *m) {
+    hw_unlock_door(m);
+    m->wash_timer = 0;
+    m->spin_timer = 0;
+    return STATUS_OK;
+}
+
+/* RUNNING owns the door interlock for every child */
+static status_t on_enter_running(wash_machine_t *m) {
+    if (m->door_open) {
+        m->error_count++;
+        printf("[ERROR] Cannot run with door open\n");
+        return STATUS_ERROR_DOOR_OPEN;
+    }
+    return hw_lock_door(m);
+}
+
+static status_t on_enter_filling(wash_machine_t *m) {
+    return hw_open_water_valve(m);
+}
+
+static status_t on_exit_filling(wash_machine_t *m) {
+    return hw_close_water_valve(m);
+}
+
+static status_t on_enter_washing(wash_machine_t *m) {
+    const program_config_t *config = &programs[m->program];
+    m->wash_timer = config->wash_time;
+    return hw_start_motor(m, config->motor_speed);
+}
+
+static status_t on_exit_washing(wash_machine_t *m) {
+    return hw_stop_motor(m);
+}
+
+static status_t on_enter_draining(wash_machine_t *m) {
+    return hw_open_drain_valve(m);
+}
+
+static status_t on_exit_draining(wash_machine_t *m) {
+    return hw_close_drain_valve(m);
+}
+
+static status_t on_enter_spinning(wash_machine_t *m) {
+    m->spin_timer = programs[m->program].spin_time;
+    return hw_start_motor(m, 100);
+}
+
+static status_t on_exit_spinning(wash_machine_t *m) {
+    return hw_stop_motor(m);
+}
+
+static status_t on_enter_done(wash_machine_t *m) {
+    hw_unlock_door(m);
+    hw_beep(m, 3);
+    return STATUS_OK;
+}
+
+static status_t on_enter_paused(wash_machine_t *m) {
+    hw_stop_motor(m);
+    hw_close_water_valve(m);
+    return STATUS_OK;
+}
+
+static status_t on_enter_error(wash_machine_t *m) {
+    hw_stop_motor(m);
+    hw_close_water_valve(m);
+    hw_close_drain_valve(m);
+    hw_beep(m, 5);
+    return STATUS_OK;
+}
+
+/* ============================================================================
+ * GUARDS, TRANSITION ACTIONS, DURING-ACTIONS
+ * ============================================================================ */
+
+static bool guard_door_closed(wash_machine_t *m) {
+    return !m->door_open;
+}
+
+static status_t action_save_history(wash_machine_t *m) {
+    m->previous_state = m->current_state;
+    return STATUS_OK;
+}
+
+static status_t action_clear_errors(wash_machine_t *m) {
+    m->error_count = 0;
+    return STATUS_OK;
+}
+
+static status_t action_brake_drum(wash_machine_t *m) {
+    return hw_brake_drum(m);
+}
+
+static wash_event_t during_washing(wash_machine_t *m, wash_event_t event) {
+    if (m->wash_timer > 0) {
+        m->wash_timer--;
+    }
+    return (m->wash_timer == 0) ? EVENT_WASH_DONE : event;
+}
+
+static wash_event_t during_spinning(wash_machine_t *m, wash_event_t event) {
+    if (m->spin_timer > 0) {
+        m->spin_timer--;
+    }
+    return (m->spin_timer == 0) ? EVENT_SPIN_DONE : event;
+}
+
+/* ============================================================================
+ * HIERARCHY AND TABLES
+ * ============================================================================ */
+
+typedef bool (*fsm_guard_t)(wash_machine_t *m);
+typedef status_t (*fsm_action_t)(wash_machine_t *m);
+typedef wash_event_t (*fsm_during_t)(wash_machine_t *m, wash_event_t event);
+
+typedef struct {
+    fsm_guard_t  guard;
+    fsm_action_t action;
+    uint8_t      target;
+    bool         handled;
+} fsm_transition_t;
+
+#define T(to, g, a)  { .guard = (g), .action = (a), .target = (to), .handled = true }
+
+static const uint8_t parent_of[STATE_MAX] = {
+    [STATE_IDLE]     = STATE_NONE,
+    [STATE_FILLING]  = STATE_WET,
+    [STATE_WASHING]  = STATE_WET,
+    [STATE_DRAINING] = STATE_RUNNING,
+    [STATE_SPINNING] = STATE_RUNNING,
+    [STATE_DONE]     = STATE_NONE,
+    [STATE_PAUSED]   = STATE_NONE,
+    [STATE_ERROR]    = STATE_NONE,
+    [STATE_RUNNING]  = STATE_NONE,
+    [STATE_WET]      = STATE_RUNNING,
+};
+
+/* Targeting a superstate enters its initial child */
+static const uint8_t initial_child[STATE_MAX] = {
+    [STATE_IDLE]     = STATE_NONE,
+    [STATE_FILLING]  = STATE_NONE,
+    [STATE_WASHING]  = STATE_NONE,
+    [STATE_DRAINING] = STATE_NONE,
+    [STATE_SPINNING] = STATE_NONE,
+    [STATE_DONE]     = STATE_NONE,
+    [STATE_PAUSED]   = STATE_NONE,
+    [STATE_ERROR]    = STATE_NONE,
+    [STATE_RUNNING]  = STATE_WET,
+    [STATE_WET]      = STATE_FILLING,
+};
+
+/* Compare with 06_table_driven.c: shared handling moved up to RUNNING/WET */
+static const fsm_transition_t transition_table[STATE_MAX][EVENT_MAX] = {
+    [STATE_IDLE] = {
+        [EVENT_START]      = T(STATE_RUNNING,  guard_door_closed, NULL),
+    },
+    [STATE_RUNNING] = {
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+    },
+    [STATE_WET] = {
+        [EVENT_PAUSE]      = T(STATE_PAUSED,   NULL, action_save_history),
+        [EVENT_STOP]       = T(STATE_DRAINING, NULL, NULL),
+    },
+    [STATE_FILLING] = {
+        [EVENT_WATER_FULL] = T(STATE_WASHING,  NULL, NULL),
+    },
+    [STATE_WASHING] = {
+        [EVENT_WASH_DONE]  = T(STATE_DRAINING, NULL, NULL),
+    },
+    [STATE_DRAINING] = {
+        [EVENT_DRAIN_DONE] = T(STATE_SPINNING, NULL, NULL),
+    },
+    [STATE_SPINNING] = {
+        [EVENT_SPIN_DONE]  = T(STATE_DONE,     NULL, NULL),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, action_brake_drum),
+    },
+    [STATE_DONE] = {
+        [EVENT_START]      = T(STATE_RUNNING,  guard_door_closed, NULL),
+    },
+    [STATE_PAUSED] = {
+        [EVENT_RESUME]     = T(STATE_HISTORY,  NULL, NULL),
+        [EVENT_STOP]       = T(STATE_IDLE,     NULL, NULL),
+    },
+    [STATE_ERROR] = {
+        [EVENT_RESET]      = T(STATE_IDLE,     NULL, action_clear_errors),
+    },
+};
+
+static const fsm_action_t entry_table[STATE_MAX] = {
+    [STATE_IDLE]     = on_enter_idle,
+    [STATE_RUNNING]  = on_enter_running,
+    [STATE_FILLING]  = on_enter_filling,
+    [STATE_WASHING]  = on_enter_washing,
+    [STATE_DRAINING] = on_enter_draining,
+    [STATE_SPINNING] = on_enter_spinning,
+    [STATE_DONE]     = on_enter_done,
+    [STATE_PAUSED]   = on_enter_paused,
+    [STATE_ERROR]    = on_enter_error,
+};
+
+static const fsm_action_t exit_table[STATE_MAX] = {
+    [STATE_FILLING]  = on_exit_filling,
+    [STATE_WASHING]  = on_exit_washing,
+    [STATE_DRAINING] = on_exit_draining,
+    [STATE_SPINNING] = on_exit_spinning,
+};
+
+static const fsm_during_t during_table[STATE_MAX] = {
+    [STATE_WASHING]  = during_washing,
+    [STATE_SPINNING] = during_spinning,
+};
+
+/* ============================================================================
+ * PRECOMPUTED PATHS
+ * ============================================================================
+ * Filled once by fsm_build_paths() (on a real product, generate them at
+ * build time - see the FSM compiler). Dispatch only indexes these.
+ */
+
+#define MAX_DEPTH 4
+
+static uint8_t depth_of[STATE_MAX];
+static uint8_t ancestry[STATE_MAX][MAX_DEPTH];     /* Root-first path to state */
+static uint8_t lca_table[STATE_MAX][STATE_MAX];   /* [leaf][target] */
+
+static void fsm_build_paths(void) {
+    for (int s = 0; s < STATE_MAX; s++) {
+        uint8_t chain[MAX_DEPTH];
+        int n = 0;
+        for (uint8_t p = s; p != STATE_NONE; p = parent_of[p]) {
+            chain[n++] = p;
+        }
+        depth_of[s] = n - 1;
+        for (int i = 0; i < n; i++) {
+            ancestry[s][i] = chain[n - 1 - i];
+        }
+    }
+
+    /*
+     * External transition semantics: the LCA is the deepest common
+     * ancestor that is a PROPER ancestor of the target, so a transition
+     * to yourself or to an ancestor exits and re-enters it.
+     */
+    for (int from = 0; from < STATE_MAX; from++) {
+        for (int to = 0; to < STATE_MAX; to++) {
+            uint8_t lca = STATE_NONE;
+            for (int d = 0; d < depth_of[to]; d++) {
+                if (d <= depth_of[from] && ancestry[from][d] == ancestry[to][d]) {
+                    lca = ancestry[to][d];
+                } else {
+                    break;
+                }
+            }
+            lca_table[from][to] = lca;
+        }
+    }
+}
+
+/* ============================================================================
+ * HIERARCHICAL ENGINE
+ * ============================================================================ */
+
+static status_t fsm_enter_failed(wash_machine_t *m, uint8_t state) {
+    printf("[ERROR] Entry action of %s failed\n", state_names[state]);
+    m->current_state = STATE_ERROR;
+    on_enter_error(m);
+    return STATUS_ERROR_HARDWARE;
+}
+
+static status_t fsm_transition(wash_machine_t *m, const fsm_transition_t *t) {
+    uint8_t leaf = m->current_state;
+    uint8_t target = (t->target == STATE_HISTORY) ? m->previous_state : t->target;
+    uint8_t lca = lca_table[leaf][target];
+    status_t status;
+
+    /* 1. Exit from the leaf up to (not including) the LCA */
+    for (uint8_t s = leaf; s != lca; s = parent_of[s]) {
+        printf("    exit  %s\n", state_names[s]);
+        if (exit_table[s]) {
+            status = exit_table[s](m);
+            if (status != STATUS_OK) {
+                m->error_count++;
+                return status;
+            }
+        }
+    }
+
+    /* 2. Transition action */
+    if (t->action) {
+        status = t->action(m);
+        if (status != STATUS_OK) {
+            m->error_count++;
+            return status;
+        }
+    }
+
+    /* 3. Enter from below the LCA down to the target */
+    uint8_t first = (lca == STATE_NONE) ? 0 : depth_of[lca] + 1;
+    for (uint8_t d = first; d <= depth_of[target]; d++) {
+        uint8_t s = ancestry[target][d];
+        printf("    enter %s\n", state_names[s]);
+        if (entry_table[s] && entry_table[s](m) != STATUS_OK) {
+            return fsm_enter_failed(m, s);
+        }
+    }
+
+    /* 4. Drill into initial children until we reach a leaf */
+    while (initial_child[target] != STATE_NONE) {
+        target = initial_child[target];
+        printf("    enter %s (initial)\n", state_names[target]);
+        if (entry_table[target] && entry_table[target](m) != STATUS_OK) {
+            return fsm_enter_failed(m, target);
+        }
+    }
+
+    printf("[LOG] State: %s -> %s\n", state_names[leaf], state_names[target]);
+    m->current_state = target;
+    m->transitions++;
+    return STATUS_OK;
+}
+
+static status_t fsm_dispatch(wash_machine_t *m, wash_event_t event) {
+    if (event >= EVENT_MAX) {
+        return STATUS_ERROR_INVALID_EVENT;
+    }
+    if (m->current_state >= STATE_MAX) {
+        return STATUS_ERROR_INVALID_STATE;
+    }
+
+    if (event != EVENT_NONE) {
+        printf("[LOG] Event: %s\n", event_names[event]);
+    }
+
+    fsm_during_t during = during_table[m->current_state];
+    if (during) {
+        event = during(m, event);
+    }
+
+    /* Walk up the hierarchy: at most depth+1 lookups */
+    for (uint8_t s = m->current_state; s != STATE_NONE; s = parent_of[s]) {
+        const fsm_transition_t *t = &transition_table[s][event];
+        if (t->handled && (!t->guard || t->guard(m))) {
+            return fsm_transition(m, t);
+        }
+    }
+
+    return STATUS_OK;  /* Unhandled at every level: ignored */
+}
+
+static void wash_machine_init(wash_machine_t *m, wash_program_t program) {
+    memset(m, 0, sizeof(*m));
+    m->current_state = STATE_IDLE;
+    m->program = program;
+}
+
+/* ============================================================================
+ * DEMO
+ * ============================================================================ */
+
+static void print_children(uint8_t parent) {
+    for (int s = 0; s < STATE_MAX; s++) {
+        if (parent_of[s] == parent) {
+            printf("  %*s%s\n", depth_of[s] * 2, "", state_names[s]);
+            print_children(s);
+        }
+    }
+}
+
+static void print_hierarchy(void) {
+    printf("State hierarchy:\n");
+    print_children(STATE_NONE);
+}
+
+static int count_cells(void) {
+    int n = 0;
+    for (int s = 0; s < STATE_MAX; s++) {
+        for (int e = 0; e < EVENT_MAX; e++) {
+            n += transition_table[s][e].handled;
+        }
+    }
+    return n;
+}
+
+static void tick(wash_machine_t *m, int n) {
+    for (int i = 0; i < n; i++) {
+        fsm_dispatch(m, EVENT_NONE);
+    }
+}
+
+int main(void) {
+    printf("=== Hierarchical State Machine ===\n\n");
+
+    fsm_build_paths();
+    print_hierarchy();
+
+    wash_machine_t m;
+    wash_machine_init(&m, PROGRAM_QUICK);
+
+    printf("\n--- START targets RUNNING: enters RUNNING, WET, FILLING ---\n");
+    fsm_dispatch(&m, EVENT_START);
+
+    printf("\n--- WATER_FULL: sibling transition, WET stays entered ---\n");
+    fsm_dispatch(&m, EVENT_WATER_FULL);
+    tick(&m, 3);
+
+    printf("\n--- PAUSE: handled by WET (inherited) ---\n");
+    fsm_dispatch(&m, EVENT_PAUSE);
+
+    printf("\n--- RESUME: history back into WASHING ---\n");
+    fsm_dispatch(&m, EVENT_RESUME);
+
+    printf("\n--- Timer expiry: WASHING -> DRAINING (leaves WET) ---\n");
+    tick(&m, 20);
+    fsm_dispatch(&m, EVENT_DRAIN_DONE);
+
+    printf("\n--- PAUSE while SPINNING: not in WET, ignored ---\n");
+    fsm_dispatch(&m, EVENT_PAUSE);
+
+    printf("\n--- ERROR while SPINNING: child overrides RUNNING ---\n");
+    fsm_dispatch(&m, EVENT_ERROR);
+
+    printf("\n--- RESET ---\n");
+    fsm_dispatch(&m, EVENT_RESET);
+
+    printf("\n=== Table Summary ===\n");
+    printf("Populated cells: %d (16 in the flat 06_table_driven.c)\n", count_cells());
+    printf("Max lookups per event: %d\n", MAX_DEPTH - 1);
+    printf("Transitions taken: %u\n", m.transitions);
+
+    printf("\n=== HSM Features ===\n");
+    printf("1. Superstates handle shared events once\n");
+    printf("2. Children override parents\n");
+    printf("3. Precomputed LCA exit/entry paths\n");
+    printf("4. Initial child for superstate targets\n");
+    printf("5. History resume into the exact leaf\n");
+
+    return 0;
+}
+
+/*
+ * HIERARCHICAL STATE MACHINE NOTES:
+ *
+ * 1. WHY
+ *    - "Any running state + ERROR -> ERROR" is written once
+ *    - New child states inherit safety handling automatically
+ *
+ * 2. COST
+ *    - Dispatch: up to depth+1 table lookups (3 here)
+ *    - Transition: exits + entries along the LCA path, no searching
+ *    - Tables: parent/initial/depth/ancestry/LCA, all byte-sized
+ *
+ * 3. SEMANTICS
+ *    - current_state is always a leaf
+ *    - External transitions (self-transition re-enters the state)
+ *    - Superstate exit actions run when the last child leaves
+ *
+ * 4. WATCH OUT
+ *    - Keep hierarchies shallow (2-3 levels)
+ *    - An override hides the parent's handling: document it
+ */
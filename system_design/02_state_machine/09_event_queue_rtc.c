@@ -0,0 +1,653 @@
+/**
+ * 09_event_queue_rtc.c - Per-Machine Event Queues, Run-to-Completion
+ *
+ * So far state_machine_run() is called directly with an event. If an
+ * entry action detects a hardware fault it can either call
+ * state_machine_run(EVENT_ERROR) from inside a transition (recursion:
+ * the outer transition then finishes on top of the inner one), or drop
+ * the event. This version gives every machine instance:
+ * - A small bounded event queue: fsm_post() only enqueues
+ * - Run-to-completion: one event is fully processed (exit, action,
+ *   entry) before the next is even looked at
+ * - Deferred events: a state can say "not now" (e.g. PAUSED defers
+ *   WATER_FULL); they are recalled, in order, after the next transition
+ * - A round-robin scheduler that serves many machines from one loop
+ *   thread, one event per machine per turn
+ *
+ * Compile: gcc -std=c11 09_event_queue_rtc.c -o event_queue_rtc
+ * Run:     ./event_queue_rtc
+ *
+ * Study time: 30 minutes
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef enum {
+    STATUS_OK = 0,
+    STATUS_ERROR_INVALID_STATE,
+    STATUS_ERROR_INVALID_EVENT,
+    STATUS_ERROR_DOOR_OPEN,
+    STATUS_ERROR_HARDWARE,
+    STATUS_ERROR_QUEUE_FULL
+} status_t;
+
+/* ============================================================================
+ * STATE MACHINE DEFINITION (same as 07_multi_instance.c)
+ * ============================================================================ */
+
+typedef enum {
+    STATE_IDLE,
+    STATE_FILLING,
+    STATE_WASHING,
+    STATE_DRAINING,
+    STATE_SPINNING,
+    STATE_DONE,
+    STATE_PAUSED,
+    STATE_ERROR,
+    STATE_MAX,
+    STATE_HISTORY = STATE_MAX
+} wash_state_t;
+
+typedef enum {
+    EVENT_START,
+    EVENT_WATER_FULL,
+    EVENT_WASH_DONE,
+    EVENT_DRAIN_DONE,
+    EVENT_SPIN_DONE,
+    EVENT_PAUSE,
+    EVENT_RESUME,
+    EVENT_STOP,
+    EVENT_ERROR,
+    EVENT_RESET,
+    EVENT_NONE,
+    EVENT_MAX
+} wash_event_t;
+
+typedef enum {
+    PROGRAM_NORMAL,
+    PROGRAM_DELICATE,
+    PROGRAM_HEAVY,
+    PROGRAM_QUICK
+} wash_program_t;
+
+typedef struct {
+    uint16_t fill_time;
+    uint16_t wash_time;
+    uint16_t spin_time;
+    uint8_t motor_speed;
+} program_config_t;
+
+static const program_config_t programs[] = {
+    [PROGRAM_NORMAL]   = {10, 30, 20, 100},
+    [PROGRAM_DELICATE] = {10, 20, 10, 50},
+    [PROGRAM_HEAVY]    = {15, 45, 30, 100},
+    [PROGRAM_QUICK]    = {5,  15, 10, 100}
+};
+
+const char* state_names[] = {
+    "IDLE", "FILLING", "WASHING", "DRAINING",
+    "SPINNING", "DONE", "PAUSED", "ERROR"
+};
+
+const char* event_names[] = {
+    "START", "WATER_FULL", "WASH_DONE", "DRAIN_DONE",
+    "SPIN_DONE", "PAUSE", "RESUME", "STOP",
+    "ERROR", "RESET", "NONE"
+};
+
+/* ============================================================================
+ * BOUNDED EVENT QUEUE
+ * ============================================================================
+ * Power-of-two ring of 1-byte events. push_front exists for recalling
+ * deferred events ahead of newer ones.
+ */
+
+#define EVENT_QUEUE_SIZE 8   /* Must be a power of 2 */
+
+typedef struct {
+    uint8_t buf[EVENT_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+} event_queue_t;
+
+static bool eq_push_back(event_queue_t *q, wash_event_t e) {
+    if (q->count == EVENT_QUEUE_SIZE) return false;
+    q->buf[(q->head + q->count) & (EVENT_QUEUE_SIZE - 1)] = (uint8_t)e;
+    q->count++;
+    return true;
+}
+
+static bool eq_push_front(event_queue_t *q, wash_event_t e) {
+    if (q->count == EVENT_QUEUE_SIZE) return false;
+    q->head = (q->head - 1) & (EVENT_QUEUE_SIZE - 1);
+    q->buf[q->head] = (uint8_t)e;
+    q->count++;
+    return true;
+}
+
+static bool eq_pop(event_queue_t *q, wash_event_t *e) {
+    if (q->count == 0) return false;
+    *e = (wash_event_t)q->buf[q->head];
+    q->head = (q->head + 1) & (EVENT_QUEUE_SIZE - 1);
+    q->count--;
+    return true;
+}
+
+/* ============================================================================
+ * MACHINE INSTANCE
+ * ============================================================================ */
+
+typedef struct {
+    uint8_t  id;
+    uint8_t  current_state;
+    uint8_t  previous_state;
+    uint8_t  program;
+    uint8_t  door_open;
+    uint8_t  drain_fault;     /* Simulated hardware fault */
+    uint8_t  scheduled;       /* Already in the ready ring */
+    uint8_t  busy;            /* Inside fsm_dispatch (RTC check) */
+    uint16_t wash_timer;
+    uint16_t spin_timer;
+    uint16_t error_count;
+    uint16_t dropped;         /* Events lost to a full queue */
+    event_queue_t queue;
+    event_queue_t deferred;
+} wash_machine_t;
+
+static status_t fsm_post(wash_machine_t *m, wash_event_t event);
+
+/* ============================================================================
+ * HARDWARE ABSTRACTION (simulated)
+ * ============================================================================ */
+
+#define HW(m, ...) do { printf("  [M%u HW] ", (m)->id); printf(__VA_ARGS__); printf("\n"); } while (0)
+
+static status_t hw_lock_door(wash_machine_t *m)         { HW(m, "Door locked");        return STATUS_OK; }
+static status_t hw_unlock_door(wash_machine_t *m)       { HW(m, "Door unlocked");      return STATUS_OK; }
+static status_t hw_open_water_valve(wash_machine_t *m)  { HW(m, "Water valve open");   return STATUS_OK; }
+static status_t hw_close_water_valve(wash_machine_t *m) { HW(m, "Water valve closed"); return STATUS_OK; }
+static status_t hw_stop_motor(wash_machine_t *m)        { HW(m, "Motor stopped");      return STATUS_OK; }
+static status_t hw_close_drain_valve(wash_machine_t *m) { HW(m, "Drain valve closed"); return STATUS_OK; }
+
+static status_t hw_open_drain_valve(wash_machine_t *m) {
+    if (m->drain_fault) {
+        HW(m, "Drain valve STUCK");
+        return STATUS_ERROR_HARDWARE;
+    }
+    HW(m, "Drain valve open");
+    return STATUS_OK;
+}
+
+static status_t hw_start_motor(wash_machine_t *m, uint8_t speed) {
+    HW(m, "Motor at %d%% speed", speed);
+    return STATUS_OK;
+}
+
+static void hw_beep(wash_machine_t *m, uint8_t count) {
+    HW(m, "BEEP! (%d times)", count);
+}
+
+/* ============================================================================
+ * STATE ACTIONS
+ * ============================================================================ */
+
+static status_t on_enter_idle(wash_machine_t *m) {
+    hw_unlock_door(m);
+    m->wash_timer = 0;
+    m->spin_timer = 0;
+    return STATUS_OK;
+}
+
+static status_t on_enter_filling(wash_machine_t *m) {
+    if (m->door_open) {
+        m->error_count++;
+        return STATUS_ERROR_DOOR_OPEN;
+    }
+    hw_lock_door(m);
+    return hw_open_water_valve(m);
+}
+
+static status_t on_exit_filling(wash_machine_t *m) {
+    return hw_close_water_valve(m);
+}
+
+static status_t on_enter_washing(wash_machine_t *m) {
+    const program_config_t *config = &programs[m->program];
+    m->wash_timer = config->wash_time;
+    return hw_start_motor(m, config->motor_speed);
+}
+
+static status_t on_exit_washing(wash_machine_t *m) {
+    return hw_stop_motor(m);
+}
+
+/*
+ * A fault detected inside an entry action is RAISED, not handled here:
+ * the ERROR transition runs after this one has completed.
+ */
+static status_t on_enter_draining(wash_machine_t *m) {
+    if (hw_open_drain_valve(m) != STATUS_OK) {
+        m->error_count++;
+        fsm_post(m, EVENT_ERROR);
+    }
+    return STATUS_OK;
+}
+
+static status_t on_exit_draining(wash_machine_t *m) {
+    return hw_close_drain_valve(m);
+}
+
+static status_t on_enter_spinning(wash_machine_t *m) {
+    m->spin_timer = programs[m->program].spin_time;
+    return hw_start_motor(m, 100);
+}
+
+static status_t on_exit_spinning(wash_machine_t *m) {
+    return hw_stop_motor(m);
+}
+
+static status_t on_enter_done(wash_machine_t *m) {
+    hw_unlock_door(m);
+    hw_beep(m, 3);
+    return STATUS_OK;
+}
+
+static status_t on_enter_paused(wash_machine_t *m) {
+    hw_stop_motor(m);
+    hw_close_water_valve(m);
+    return STATUS_OK;
+}
+
+static status_t on_enter_error(wash_machine_t *m) {
+    hw_stop_motor(m);
+    hw_close_water_valve(m);
+    hw_close_drain_valve(m);
+    hw_beep(m, 5);
+    return STATUS_OK;
+}
+
+static bool guard_door_closed(wash_machine_t *m) {
+    return !m->door_open;
+}
+
+static status_t action_save_history(wash_machine_t *m) {
+    m->previous_state = m->current_state;
+    return STATUS_OK;
+}
+
+static status_t action_clear_errors(wash_machine_t *m) {
+    m->error_count = 0;
+    m->drain_fault = 0;  /* Service engineer fixed the valve */
+    return STATUS_OK;
+}
+
+static wash_event_t during_washing(wash_machine_t *m, wash_event_t event) {
+    if (m->wash_timer > 0) {
+        m->wash_timer--;
+    }
+    return (m->wash_timer == 0) ? EVENT_WASH_DONE : event;
+}
+
+static wash_event_t during_spinning(wash_machine_t *m, wash_event_t event) {
+    if (m->spin_timer > 0) {
+        m->spin_timer--;
+    }
+    return (m->spin_timer == 0) ? EVENT_SPIN_DONE : event;
+}
+
+/* ============================================================================
+ * ENGINE TABLES (07_multi_instance.c + defer masks)
+ * ============================================================================ */
+
+typedef bool (*fsm_guard_t)(wash_machine_t *m);
+typedef status_t (*fsm_action_t)(wash_machine_t *m);
+typedef wash_event_t (*fsm_during_t)(wash_machine_t *m, wash_event_t event);
+
+typedef struct {
+    fsm_guard_t  guard;
+    fsm_action_t action;
+    uint8_t      target;
+    bool         handled;
+} fsm_transition_t;
+
+#define T(to, g, a)  { .guard = (g), .action = (a), .target = (to), .handled = true }
+#define EV(e)        (1u << (e))
+
+static const fsm_transition_t transition_table[STATE_MAX][EVENT_MAX] = {
+    [STATE_IDLE] = {
+        [EVENT_START]      = T(STATE_FILLING,  guard_door_closed, NULL),
+    },
+    [STATE_FILLING] = {
+        [EVENT_WATER_FULL] = T(STATE_WASHING,  NULL, NULL),
+        [EVENT_PAUSE]      = T(STATE_PAUSED,   NULL, action_save_history),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+        [EVENT_STOP]       = T(STATE_DRAINING, NULL, NULL),
+    },
+    [STATE_WASHING] = {
+        [EVENT_WASH_DONE]  = T(STATE_DRAINING, NULL, NULL),
+        [EVENT_PAUSE]      = T(STATE_PAUSED,   NULL, action_save_history),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+    },
+    [STATE_DRAINING] = {
+        [EVENT_DRAIN_DONE] = T(STATE_SPINNING, NULL, NULL),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+    },
+    [STATE_SPINNING] = {
+        [EVENT_SPIN_DONE]  = T(STATE_DONE,     NULL, NULL),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+    },
+    [STATE_DONE] = {
+        [EVENT_START]      = T(STATE_FILLING,  guard_door_closed, NULL),
+    },
+    [STATE_PAUSED] = {
+        [EVENT_RESUME]     = T(STATE_HISTORY,  NULL, NULL),
+        [EVENT_STOP]       = T(STATE_IDLE,     NULL, NULL),
+    },
+    [STATE_ERROR] = {
+        [EVENT_RESET]      = T(STATE_IDLE,     NULL, action_clear_errors),
+    },
+};
+
+/*
+ * Events a state postpones instead of ignoring. While PAUSED, a level
+ * sensor reporting WATER_FULL or a drain reporting DRAIN_DONE must not
+ * be lost: they are handled once the machine resumes.
+ */
+static const uint16_t defer_mask[STATE_MAX] = {
+    [STATE_PAUSED] = EV(EVENT_WATER_FULL) | EV(EVENT_DRAIN_DONE),
+};
+
+static const fsm_action_t entry_table[STATE_MAX] = {
+    [STATE_IDLE]     = on_enter_idle,
+    [STATE_FILLING]  = on_enter_filling,
+    [STATE_WASHING]  = on_enter_washing,
+    [STATE_DRAINING] = on_enter_draining,
+    [STATE_SPINNING] = on_enter_spinning,
+    [STATE_DONE]     = on_enter_done,
+    [STATE_PAUSED]   = on_enter_paused,
+    [STATE_ERROR]    = on_enter_error,
+};
+
+static const fsm_action_t exit_table[STATE_MAX] = {
+    [STATE_FILLING]  = on_exit_filling,
+    [STATE_WASHING]  = on_exit_washing,
+    [STATE_DRAINING] = on_exit_draining,
+    [STATE_SPINNING] = on_exit_spinning,
+};
+
+static const fsm_during_t during_table[STATE_MAX] = {
+    [STATE_WASHING]  = during_washing,
+    [STATE_SPINNING] = during_spinning,
+};
+
+/* ============================================================================
+ * ROUND-ROBIN SCHEDULER
+ * ============================================================================
+ * Ring of machines that have at least one queued event. A machine is in
+ * the ring at most once (m->scheduled), so the ring never overflows.
+ */
+
+#define MAX_MACHINES 16
+
+static wash_machine_t *ready_ring[MAX_MACHINES];
+static uint32_t ready_head = 0;
+static uint32_t ready_count = 0;
+
+static void sched_make_ready(wash_machine_t *m) {
+    if (m->scheduled) return;
+    m->scheduled = 1;
+    ready_ring[(ready_head + ready_count) % MAX_MACHINES] = m;
+    ready_count++;
+}
+
+static wash_machine_t* sched_next(void) {
+    if (ready_count == 0) return NULL;
+    wash_machine_t *m = ready_ring[ready_head];
+    ready_head = (ready_head + 1) % MAX_MACHINES;
+    ready_count--;
+    m->scheduled = 0;
+    return m;
+}
+
+/* Post = enqueue only; never dispatches (safe from inside actions) */
+static status_t fsm_post(wash_machine_t *m, wash_event_t event) {
+    if (event >= EVENT_MAX) {
+        return STATUS_ERROR_INVALID_EVENT;
+    }
+    if (!eq_push_back(&m->queue, event)) {
+        m->dropped++;
+        return STATUS_ERROR_QUEUE_FULL;
+    }
+    sched_make_ready(m);
+    return STATUS_OK;
+}
+
+/* ============================================================================
+ * ENGINE
+ * ============================================================================ */
+
+/* Put deferred events back at the FRONT of the queue, oldest first */
+static void fsm_recall_deferred(wash_machine_t *m) {
+    wash_event_t stash[EVENT_QUEUE_SIZE];
+    int n = 0;
+    wash_event_t e;
+
+    while (eq_pop(&m->deferred, &e)) {
+        stash[n++] = e;
+    }
+    while (n > 0) {
+        if (!eq_push_front(&m->queue, stash[--n])) {
+            m->dropped++;
+        }
+    }
+    sched_make_ready(m);
+}
+
+static status_t fsm_transition(wash_machine_t *m, const fsm_transition_t *t) {
+    wash_state_t old_state = m->current_state;
+    wash_state_t new_state = (t->target == STATE_HISTORY)
+                             ? (wash_state_t)m->previous_state : (wash_state_t)t->target;
+    status_t status;
+
+    if (exit_table[old_state]) {
+        status = exit_table[old_state](m);
+        if (status != STATUS_OK) {
+            m->error_count++;
+            return status;
+        }
+    }
+
+    if (t->action) {
+        status = t->action(m);
+        if (status != STATUS_OK) {
+            m->error_count++;
+            return status;
+        }
+    }
+
+    m->current_state = new_state;
+    printf("[M%u] State: %s -> %s\n", m->id, state_names[old_state], state_names[new_state]);
+
+    status = entry_table[new_state](m);
+    if (status != STATUS_OK) {
+        m->current_state = STATE_ERROR;
+        on_enter_error(m);
+    }
+
+    if (m->deferred.count > 0) {
+        fsm_recall_deferred(m);
+    }
+
+    return status;
+}
+
+/* Process exactly one event to completion */
+static status_t fsm_dispatch(wash_machine_t *m, wash_event_t event) {
+    status_t status = STATUS_OK;
+
+    if (m->busy) {
+        return STATUS_ERROR_INVALID_STATE;  /* RTC violated: use fsm_post() */
+    }
+    m->busy = 1;
+
+    if (event != EVENT_NONE) {
+        printf("[M%u] Event: %s\n", m->id, event_names[event]);
+    }
+
+    if (defer_mask[m->current_state] & EV(event)) {
+        printf("[M%u] Deferred %s while %s\n", m->id, event_names[event],
+               state_names[m->current_state]);
+        if (!eq_push_back(&m->deferred, event)) {
+            m->dropped++;
+        }
+        m->busy = 0;
+        return STATUS_OK;
+    }
+
+    fsm_during_t during = during_table[m->current_state];
+    if (during) {
+        event = during(m, event);
+    }
+
+    const fsm_transition_t *t = &transition_table[m->current_state][event];
+    if (t->handled && (!t->guard || t->guard(m))) {
+        status = fsm_transition(m, t);
+    }
+
+    m->busy = 0;
+    return status;
+}
+
+/*
+ * One scheduler turn: take the next ready machine, run ONE event to
+ * completion, and put it back at the tail if it still has work.
+ */
+static bool sched_run_one(void) {
+    wash_machine_t *m = sched_next();
+    wash_event_t e;
+
+    if (!m) return false;
+    if (eq_pop(&m->queue, &e)) {
+        fsm_dispatch(m, e);
+    }
+    if (m->queue.count > 0) {
+        sched_make_ready(m);
+    }
+    return true;
+}
+
+/* Drain everything that is ready (including events raised on the way) */
+static uint32_t sched_run_until_idle(void) {
+    uint32_t n = 0;
+    while (sched_run_one()) {
+        n++;
+    }
+    return n;
+}
+
+static void wash_machine_init(wash_machine_t *m, uint8_t id, wash_program_t program) {
+    memset(m, 0, sizeof(*m));
+    m->id = id;
+    m->current_state = STATE_IDLE;
+    m->program = program;
+}
+
+/* ============================================================================
+ * DEMO
+ * ============================================================================ */
+
+#define NUM_MACHINES 3
+
+static wash_machine_t machines[NUM_MACHINES];
+
+/* Timer tick for every machine that has a running timer */
+static void post_ticks(void) {
+    for (int i = 0; i < NUM_MACHINES; i++) {
+        uint8_t s = machines[i].current_state;
+        if (s == STATE_WASHING || s == STATE_SPINNING) {
+            fsm_post(&machines[i], EVENT_NONE);
+        }
+    }
+}
+
+int main(void) {
+    printf("=== Event Queues + Run-to-Completion Scheduler ===\n\n");
+
+    for (int i = 0; i < NUM_MACHINES; i++) {
+        wash_machine_init(&machines[i], i, PROGRAM_QUICK);
+    }
+    machines[2].drain_fault = 1;
+
+    printf("--- All three machines start (round-robin) ---\n");
+    for (int i = 0; i < NUM_MACHINES; i++) {
+        fsm_post(&machines[i], EVENT_START);
+    }
+    sched_run_until_idle();
+
+    printf("\n--- M1 is paused, then its level sensor reports full ---\n");
+    fsm_post(&machines[0], EVENT_WATER_FULL);
+    fsm_post(&machines[1], EVENT_PAUSE);
+    fsm_post(&machines[1], EVENT_WATER_FULL);
+    fsm_post(&machines[2], EVENT_WATER_FULL);
+    sched_run_until_idle();
+
+    printf("\n--- M1 resumes: deferred WATER_FULL is recalled ---\n");
+    fsm_post(&machines[1], EVENT_RESUME);
+    sched_run_until_idle();
+
+    printf("\n--- Wash timers run out (ticks omitted from log) ---\n");
+    for (int t = 0; t < 20; t++) {
+        post_ticks();
+        sched_run_until_idle();
+    }
+
+    printf("\n--- M2's drain entry action raised ERROR; RESET it ---\n");
+    fsm_post(&machines[2], EVENT_RESET);
+    sched_run_until_idle();
+
+    printf("\n--- Queue overflow is counted, not silent ---\n");
+    for (int i = 0; i < EVENT_QUEUE_SIZE + 3; i++) {
+        fsm_post(&machines[0], EVENT_NONE);
+    }
+    printf("M0 queued %u, dropped %u\n", machines[0].queue.count, machines[0].dropped);
+    sched_run_until_idle();
+
+    printf("\n=== Final States ===\n");
+    for (int i = 0; i < NUM_MACHINES; i++) {
+        printf("M%d: %-9s errors=%u dropped=%u\n", i,
+               state_names[machines[i].current_state],
+               machines[i].error_count, machines[i].dropped);
+    }
+
+    printf("\n=== RTC Features ===\n");
+    printf("1. fsm_post() never recurses into the engine\n");
+    printf("2. Events raised by actions run after the current transition\n");
+    printf("3. Deferred events recalled in order after a state change\n");
+    printf("4. Bounded queues with overflow counting\n");
+    printf("5. One loop thread, fair round-robin across machines\n");
+
+    return 0;
+}
+
+/*
+ * RUN-TO-COMPLETION NOTES:
+ *
+ * 1. WHY
+ *    - A transition never observes a half-finished transition
+ *    - Stack depth is bounded: no dispatch inside dispatch
+ *
+ * 2. QUEUE SIZING
+ *    - Worst-case burst per machine between scheduler turns
+ *    - Count drops; size so that the count stays at zero
+ *
+ * 3. DEFERRAL
+ *    - Defer = "handle later", ignore = "never handle"
+ *    - Deferred queue is bounded too
+ *
+ * 4. ON A REAL MCU
+ *    - ISRs call fsm_post() (make the queue ISR-safe)
+ *    - Main loop calls sched_run_one(); sleep when nothing is ready
+ */
@@ -0,0 +1,637 @@
+/**
+ * 11_fsm_compiler.c - FSM Definition Compiler
+ *
+ * 06-10 all repeat the same machine by hand: the state enum, the event
+ * enum, state_names[], the transition table and the entry/exit/during
+ * arrays. Add a state and you must touch all of them, in the same order,
+ * and nothing tells you when you forget one.
+ *
+ * This build-time tool reads a declarative description (11_wash_machine.fsm)
+ * and generates:
+ * - <prefix>.h         state/event enums, name tables, initial state
+ * - <prefix>_tables.h  callback prototypes, dense transition table,
+ *                      entry/exit/during dispatch arrays
+ *
+ * It rejects the definition (exit 1, so make stops) when:
+ * - A state cannot be reached from the initial state
+ * - An event is handled by no state and not declared 'ignore'
+ * - A name is unknown, duplicated, or a (state, event) cell is defined twice
+ * and warns about states with no way out.
+ *
+ * Compile: gcc -O2 -std=c11 11_fsm_compiler.c -o 11_fsm_compiler
+ * Run:     ./11_fsm_compiler 11_wash_machine.fsm wash_fsm
+ * (or just 'make', which regenerates the headers when the .fsm changes)
+ *
+ * Study time: 20 minutes
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define MAX_STATES       32
+#define MAX_EVENTS       32
+#define MAX_TRANSITIONS  (MAX_STATES * MAX_EVENTS)
+#define MAX_NAME         48
+#define MAX_LINE         256
+#define MAX_TOKENS       16
+
+#define HISTORY_TARGET   (-1)
+
+typedef struct {
+    char name[MAX_NAME];
+    char entry[MAX_NAME];
+    char exit[MAX_NAME];
+    char during[MAX_NAME];
+} state_def_t;
+
+typedef struct {
+    char name[MAX_NAME];
+    bool ignored;
+} event_def_t;
+
+typedef struct {
+    int  from;
+    int  event;
+    int  target;             /* State index or HISTORY_TARGET */
+    char guard[MAX_NAME];
+    char action[MAX_NAME];
+    int  line;
+} transition_def_t;
+
+typedef struct {
+    const char *path;
+    char machine[MAX_NAME];
+    char context[MAX_NAME];
+    state_def_t states[MAX_STATES];
+    int num_states;
+    event_def_t events[MAX_EVENTS];
+    int num_events;
+    int initial;
+    transition_def_t transitions[MAX_TRANSITIONS];
+    int num_transitions;
+    int errors;
+    int warnings;
+} fsm_def_t;
+
+static fsm_def_t def;
+
+/* ============================================================================
+ * DIAGNOSTICS (compiler-style: file:line: error: ...)
+ * ============================================================================ */
+
+/* Line 0 = whole-machine check, reported against the file only */
+static void diag_prefix(int line, const char *kind) {
+    if (line > 0) fprintf(stderr, "%s:%d: %s: ", def.path, line, kind);
+    else          fprintf(stderr, "%s: %s: ", def.path, kind);
+}
+
+#define ERROR_AT(line, ...) do {                                  \
+    diag_prefix((line), "error");                                 \
+    fprintf(stderr, __VA_ARGS__);                                 \
+    fputc('\n', stderr);                                          \
+    def.errors++;                                                 \
+} while (0)
+
+#define WARN_AT(line, ...) do {                                   \
+    diag_prefix((line), "warning");                               \
+    fprintf(stderr, __VA_ARGS__);                                 \
+    fputc('\n', stderr);                                          \
+    def.warnings++;                                               \
+} while (0)
+
+/* ============================================================================
+ * PARSER
+ * ============================================================================ */
+
+static int find_state(const char *name) {
+    for (int i = 0; i < def.num_states; i++) {
+        if (strcmp(def.states[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+static int find_event(const char *name) {
+    for (int i = 0; i < def.num_events; i++) {
+        if (strcmp(def.events[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+/* Names end up in C identifiers: [A-Za-z_][A-Za-z0-9_]* */
+static bool valid_identifier(const char *s) {
+    if (!isalpha((unsigned char)*s) && *s != '_') return false;
+    for (s++; *s; s++) {
+        if (!isalnum((unsigned char)*s) && *s != '_') return false;
+    }
+    return true;
+}
+
+static bool copy_name(char *dst, const char *src, int line) {
+    if (!valid_identifier(src)) {
+        ERROR_AT(line, "'%s' is not a valid C identifier", src);
+        return false;
+    }
+    if (strlen(src) >= MAX_NAME) {
+        ERROR_AT(line, "name '%s' is too long (max %d)", src, MAX_NAME - 1);
+        return false;
+    }
+    strcpy(dst, src);
+    return true;
+}
+
+static int split(char *line, char *tokens[MAX_TOKENS]) {
+    int n = 0;
+    char *hash = strchr(line, '#');
+    if (hash) *hash = '\0';
+
+    for (char *tok = strtok(line, " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n")) {
+        if (n == MAX_TOKENS) return -1;
+        tokens[n++] = tok;
+    }
+    return n;
+}
+
+static void parse_states(char **tok, int n, int line) {
+    for (int i = 1; i < n; i++) {
+        if (find_state(tok[i]) >= 0) {
+            ERROR_AT(line, "state '%s' declared twice", tok[i]);
+        } else if (strcmp(tok[i], "HISTORY") == 0 || strcmp(tok[i], "MAX") == 0) {
+            ERROR_AT(line, "'%s' is reserved", tok[i]);
+        } else if (def.num_states == MAX_STATES) {
+            ERROR_AT(line, "too many states (max %d)", MAX_STATES);
+        } else if (copy_name(def.states[def.num_states].name, tok[i], line)) {
+            def.num_states++;
+        }
+    }
+}
+
+static void parse_events(char **tok, int n, int line) {
+    for (int i = 1; i < n; i++) {
+        if (find_event(tok[i]) >= 0) {
+            ERROR_AT(line, "event '%s' declared twice", tok[i]);
+        } else if (strcmp(tok[i], "MAX") == 0) {
+            ERROR_AT(line, "'%s' is reserved", tok[i]);
+        } else if (def.num_events == MAX_EVENTS) {
+            ERROR_AT(line, "too many events (max %d)", MAX_EVENTS);
+        } else if (copy_name(def.events[def.num_events].name, tok[i], line)) {
+            def.num_events++;
+        }
+    }
+}
+
+/* entry/exit/during <STATE> <function> */
+static void parse_hook(char **tok, int n, int line) {
+    if (n != 3) {
+        ERROR_AT(line, "expected '%s <state> <function>'", tok[0]);
+        return;
+    }
+
+    int s = find_state(tok[1]);
+    if (s < 0) {
+        ERROR_AT(line, "unknown state '%s'", tok[1]);
+        return;
+    }
+
+    char *slot = (strcmp(tok[0], "entry") == 0) ? def.states[s].entry
+               : (strcmp(tok[0], "exit") == 0)  ? def.states[s].exit
+               :                                  def.states[s].during;
+    if (slot[0] != '\0') {
+        ERROR_AT(line, "%s action for %s already set to %s", tok[0], tok[1], slot);
+        return;
+    }
+    copy_name(slot, tok[2], line);
+}
+
+/* <STATE> <EVENT> -> <TARGET|HISTORY> [if <guard>] [do <action>] */
+static void parse_transition(char **tok, int n, int line) {
+    transition_def_t *t;
+
+    if (def.num_transitions == MAX_TRANSITIONS) {
+        ERROR_AT(line, "too many transitions");
+        return;
+    }
+    t = &def.transitions[def.num_transitions];
+    memset(t, 0, sizeof(*t));
+    t->line = line;
+
+    t->from = find_state(tok[0]);
+    t->event = find_event(tok[1]);
+    t->target = (strcmp(tok[3], "HISTORY") == 0) ? HISTORY_TARGET : find_state(tok[3]);
+
+    if (t->from < 0)  { ERROR_AT(line, "unknown state '%s'", tok[0]); return; }
+    if (t->event < 0) { ERROR_AT(line, "unknown event '%s'", tok[1]); return; }
+    if (strcmp(tok[3], "HISTORY") != 0 && t->target < 0) {
+        ERROR_AT(line, "unknown target state '%s'", tok[3]);
+        return;
+    }
+
+    for (int i = 4; i < n; i += 2) {
+        if (i + 1 >= n) {
+            ERROR_AT(line, "'%s' needs a function name", tok[i]);
+            return;
+        }
+        if (strcmp(tok[i], "if") == 0) {
+            copy_name(t->guard, tok[i + 1], line);
+        } else if (strcmp(tok[i], "do") == 0) {
+            copy_name(t->action, tok[i + 1], line);
+        } else {
+            ERROR_AT(line, "expected 'if' or 'do', got '%s'", tok[i]);
+            return;
+        }
+    }
+
+    /* One cell per (state, event): the engine has no room for a second */
+    for (int i = 0; i < def.num_transitions; i++) {
+        if (def.transitions[i].from == t->from && def.transitions[i].event == t->event) {
+            ERROR_AT(line, "%s + %s already defined at line %d",
+                     tok[0], tok[1], def.transitions[i].line);
+            return;
+        }
+    }
+
+    def.num_transitions++;
+}
+
+static bool parse_file(const char *path) {
+    char buf[MAX_LINE];
+    char *tok[MAX_TOKENS];
+    int initial_line = 0;
+    char initial_name[MAX_NAME] = "";
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    def.path = path;
+    def.initial = -1;
+
+    for (int line = 1; fgets(buf, sizeof(buf), f); line++) {
+        /* No newline and not at EOF: fgets split the line */
+        if (!strchr(buf, '\n') && !feof(f)) {
+            int c;
+            ERROR_AT(line, "line too long (max %d characters)", MAX_LINE - 2);
+            while ((c = fgetc(f)) != EOF && c != '\n') {
+                /* discard the rest of the line */
+            }
+            continue;
+        }
+
+        int n = split(buf, tok);
+        if (n == 0) continue;
+        if (n < 0) {
+            ERROR_AT(line, "too many tokens (max %d)", MAX_TOKENS);
+            continue;
+        }
+
+        if (strcmp(tok[0], "machine") == 0 && n == 2) {
+            copy_name(def.machine, tok[1], line);
+        } else if (strcmp(tok[0], "context") == 0 && n == 2) {
+            copy_name(def.context, tok[1], line);
+        } else if (strcmp(tok[0], "states") == 0) {
+            parse_states(tok, n, line);
+        } else if (strcmp(tok[0], "events") == 0) {
+            parse_events(tok, n, line);
+        } else if (strcmp(tok[0], "initial") == 0 && n == 2) {
+            /* Resolved after the whole file: 'initial' may precede 'states' */
+            initial_line = line;
+            snprintf(initial_name, sizeof(initial_name), "%s", tok[1]);
+        } else if (strcmp(tok[0], "ignore") == 0 && n >= 2) {
+            for (int i = 1; i < n; i++) {
+                int e = find_event(tok[i]);
+                if (e < 0) ERROR_AT(line, "unknown event '%s'", tok[i]);
+                else def.events[e].ignored = true;
+            }
+        } else if (strcmp(tok[0], "entry") == 0 || strcmp(tok[0], "exit") == 0 ||
+                   strcmp(tok[0], "during") == 0) {
+            parse_hook(tok, n, line);
+        } else if (n >= 4 && strcmp(tok[2], "->") == 0) {
+            parse_transition(tok, n, line);
+        } else {
+            ERROR_AT(line, "cannot parse '%s ...'", tok[0]);
+        }
+    }
+    fclose(f);
+
+    if (def.machine[0] == '\0') ERROR_AT(0, "missing 'machine <name>'");
+    if (def.context[0] == '\0') ERROR_AT(0, "missing 'context <type>'");
+    if (def.num_states == 0)    ERROR_AT(0, "no states declared");
+    if (def.num_events == 0)    ERROR_AT(0, "no events declared");
+
+    if (initial_line == 0) {
+        ERROR_AT(0, "missing 'initial <state>'");
+    } else if ((def.initial = find_state(initial_name)) < 0) {
+        ERROR_AT(initial_line, "unknown initial state '%s'", initial_name);
+    }
+
+    return def.errors == 0;
+}
+
+/* ============================================================================
+ * VALIDATION
+ * ============================================================================ */
+
+/*
+ * Reachability: breadth-first search over the transitions from the
+ * initial state. A HISTORY target in state P can return to any state
+ * that has a transition INTO P (that is where the history was saved).
+ */
+static void check_reachability(void) {
+    bool reached[MAX_STATES] = {false};
+    int queue[MAX_STATES];
+    int head = 0, tail = 0;
+
+    reached[def.initial] = true;
+    queue[tail++] = def.initial;
+
+    while (head < tail) {
+        int s = queue[head++];
+
+        for (int i = 0; i < def.num_transitions; i++) {
+            const transition_def_t *t = &def.transitions[i];
+            if (t->from != s) continue;
+
+            if (t->target != HISTORY_TARGET) {
+                if (!reached[t->target]) {
+                    reached[t->target] = true;
+                    queue[tail++] = t->target;
+                }
+                continue;
+            }
+
+            for (int j = 0; j < def.num_transitions; j++) {
+                int back = def.transitions[j].from;
+                if (def.transitions[j].target == s && !reached[back]) {
+                    reached[back] = true;
+                    queue[tail++] = back;
+                }
+            }
+        }
+    }
+
+    for (int s = 0; s < def.num_states; s++) {
+        if (!reached[s]) {
+            ERROR_AT(0, "state %s is unreachable from %s",
+                     def.states[s].name, def.states[def.initial].name);
+        }
+    }
+}
+
+static void check_events(void) {
+    for (int e = 0; e < def.num_events; e++) {
+        bool handled = false;
+        for (int i = 0; i < def.num_transitions && !handled; i++) {
+            handled = (def.transitions[i].event == e);
+        }
+
+        if (!handled && !def.events[e].ignored) {
+            ERROR_AT(0, "event %s is not handled in any state "
+                        "(add a transition or 'ignore %s')",
+                     def.events[e].name, def.events[e].name);
+        } else if (handled && def.events[e].ignored) {
+            WARN_AT(0, "event %s is declared 'ignore' but has transitions",
+                    def.events[e].name);
+        }
+    }
+}
+
+/* A state with no outgoing transition is a trap; legal, but rarely meant */
+static void check_dead_ends(void) {
+    for (int s = 0; s < def.num_states; s++) {
+        bool has_exit = false;
+        for (int i = 0; i < def.num_transitions && !has_exit; i++) {
+            has_exit = (def.transitions[i].from == s);
+        }
+        if (!has_exit) {
+            WARN_AT(0, "state %s has no outgoing transitions", def.states[s].name);
+        }
+    }
+}
+
+/* ============================================================================
+ * CODE GENERATION
+ * ============================================================================ */
+
+static void upper(char *dst, const char *src, size_t size) {
+    size_t i;
+    for (i = 0; i + 1 < size && src[i]; i++) {
+        dst[i] = (char)toupper((unsigned char)src[i]);
+    }
+    dst[i] = '\0';
+}
+
+static void emit_banner(FILE *out, const char *file) {
+    fprintf(out, "/*\n");
+    fprintf(out, " * %s - GENERATED by 11_fsm_compiler from %s\n", file, def.path);
+    fprintf(out, " * DO NOT EDIT: change the .fsm file and rebuild.\n");
+    fprintf(out, " */\n\n");
+}
+
+static bool emit_types(const char *path, const char *file) {
+    char guard[MAX_NAME + 8];
+    FILE *out = fopen(path, "w");
+
+    if (!out) {
+        perror(path);
+        return false;
+    }
+    upper(guard, def.machine, sizeof(guard));
+
+    emit_banner(out, file);
+    fprintf(out, "#ifndef %s_FSM_H\n#define %s_FSM_H\n\n", guard, guard);
+
+    fprintf(out, "typedef enum {\n");
+    for (int s = 0; s < def.num_states; s++) {
+        fprintf(out, "    STATE_%s,\n", def.states[s].name);
+    }
+    fprintf(out, "    STATE_MAX,\n");
+    fprintf(out, "    STATE_HISTORY = STATE_MAX\n");
+    fprintf(out, "} %s_state_t;\n\n", def.machine);
+
+    fprintf(out, "typedef enum {\n");
+    for (int e = 0; e < def.num_events; e++) {
+        fprintf(out, "    EVENT_%s,\n", def.events[e].name);
+    }
+    fprintf(out, "    EVENT_MAX\n");
+    fprintf(out, "} %s_event_t;\n\n", def.machine);
+
+    fprintf(out, "#define %s_INITIAL_STATE STATE_%s\n\n", guard, def.states[def.initial].name);
+
+    fprintf(out, "static const char *const state_names[STATE_MAX] = {\n");
+    for (int s = 0; s < def.num_states; s++) {
+        fprintf(out, "    \"%s\",\n", def.states[s].name);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const char *const event_names[EVENT_MAX] = {\n");
+    for (int e = 0; e < def.num_events; e++) {
+        fprintf(out, "    \"%s\",\n", def.events[e].name);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "#endif /* %s_FSM_H */\n", guard);
+    return fclose(out) == 0;
+}
+
+/* Each callback is declared once, however many cells refer to it */
+static void emit_prototype(FILE *out, const char *fn, const char *kind,
+                           char seen[][MAX_NAME], int *num_seen) {
+    if (fn[0] == '\0') return;
+    for (int i = 0; i < *num_seen; i++) {
+        if (strcmp(seen[i], fn) == 0) return;
+    }
+    strcpy(seen[(*num_seen)++], fn);
+
+    if (strcmp(kind, "guard") == 0) {
+        fprintf(out, "static bool %s(%s *m);\n", fn, def.context);
+    } else if (strcmp(kind, "during") == 0) {
+        fprintf(out, "static %s_event_t %s(%s *m, %s_event_t event);\n",
+                def.machine, fn, def.context, def.machine);
+    } else {
+        fprintf(out, "static status_t %s(%s *m);\n", fn, def.context);
+    }
+}
+
+/* Spaces that align name to width; none if the name is already wider */
+static int pad_to(int width, const char *name) {
+    int len = (int)strlen(name);
+    return len < width ? width - len : 0;
+}
+
+static void emit_hook_table(FILE *out, const char *type, const char *name, size_t field) {
+    fprintf(out, "static const %s %s[STATE_MAX] = {\n", type, name);
+    for (int s = 0; s < def.num_states; s++) {
+        const char *fn = (const char *)&def.states[s] + field;
+        if (fn[0] != '\0') {
+            fprintf(out, "    [STATE_%s]%*s = %s,\n", def.states[s].name,
+                    pad_to(MAX_NAME / 4, def.states[s].name), "", fn);
+        }
+    }
+    fprintf(out, "};\n\n");
+}
+
+static bool emit_tables(const char *path, const char *file, const char *types_file) {
+    char guard[MAX_NAME + 8];
+    static char seen[MAX_TRANSITIONS + 3 * MAX_STATES][MAX_NAME];
+    int num_seen = 0;
+    FILE *out = fopen(path, "w");
+
+    if (!out) {
+        perror(path);
+        return false;
+    }
+    upper(guard, def.machine, sizeof(guard));
+
+    emit_banner(out, file);
+    fprintf(out, "#ifndef %s_FSM_TABLES_H\n#define %s_FSM_TABLES_H\n\n", guard, guard);
+    fprintf(out, "/*\n");
+    fprintf(out, " * Include after %s, the definition of %s and status_t\n",
+            types_file, def.context);
+    fprintf(out, " * (with STATUS_OK). Every function below must be defined by the\n");
+    fprintf(out, " * including file; a missing one is a compile error.\n");
+    fprintf(out, " */\n\n");
+
+    fprintf(out, "typedef bool (*fsm_guard_t)(%s *m);\n", def.context);
+    fprintf(out, "typedef status_t (*fsm_action_t)(%s *m);\n", def.context);
+    fprintf(out, "typedef %s_event_t (*fsm_during_t)(%s *m, %s_event_t event);\n\n",
+            def.machine, def.context, def.machine);
+
+    fprintf(out, "typedef struct {\n");
+    fprintf(out, "    fsm_guard_t  guard;\n");
+    fprintf(out, "    fsm_action_t action;\n");
+    fprintf(out, "    uint8_t      target;\n");
+    fprintf(out, "    bool         handled;\n");
+    fprintf(out, "} fsm_transition_t;\n\n");
+
+    for (int s = 0; s < def.num_states; s++) {
+        emit_prototype(out, def.states[s].entry, "action", seen, &num_seen);
+        emit_prototype(out, def.states[s].exit, "action", seen, &num_seen);
+        emit_prototype(out, def.states[s].during, "during", seen, &num_seen);
+    }
+    for (int i = 0; i < def.num_transitions; i++) {
+        emit_prototype(out, def.transitions[i].guard, "guard", seen, &num_seen);
+        emit_prototype(out, def.transitions[i].action, "action", seen, &num_seen);
+    }
+    fprintf(out, "\n");
+
+    /* Rows in state order, cells in source order: diffs stay readable */
+    fprintf(out, "static const fsm_transition_t transition_table[STATE_MAX][EVENT_MAX] = {\n");
+    for (int s = 0; s < def.num_states; s++) {
+        fprintf(out, "    [STATE_%s] = {\n", def.states[s].name);
+        for (int i = 0; i < def.num_transitions; i++) {
+            const transition_def_t *t = &def.transitions[i];
+            if (t->from != s) continue;
+
+            char target[MAX_NAME + 8];
+            snprintf(target, sizeof(target), "STATE_%s",
+                     t->target == HISTORY_TARGET ? "HISTORY" : def.states[t->target].name);
+            fprintf(out, "        [EVENT_%s]%*s = { .guard = %s, .action = %s, "
+                         ".target = %s, .handled = true },\n",
+                    def.events[t->event].name,
+                    pad_to(MAX_NAME / 4, def.events[t->event].name), "",
+                    t->guard[0] ? t->guard : "NULL",
+                    t->action[0] ? t->action : "NULL", target);
+        }
+        fprintf(out, "    },\n");
+    }
+    fprintf(out, "};\n\n");
+
+    emit_hook_table(out, "fsm_action_t", "entry_table", offsetof(state_def_t, entry));
+    emit_hook_table(out, "fsm_action_t", "exit_table", offsetof(state_def_t, exit));
+    emit_hook_table(out, "fsm_during_t", "during_table", offsetof(state_def_t, during));
+
+    fprintf(out, "#endif /* %s_FSM_TABLES_H */\n", guard);
+    return fclose(out) == 0;
+}
+
+/* ============================================================================
+ * MAIN
+ * ============================================================================ */
+
+int main(int argc, char *argv[]) {
+    char types_path[256], tables_path[256];
+    const char *types_file, *tables_file;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <machine.fsm> <output-prefix>\n", argv[0]);
+        fprintf(stderr, "  writes <output-prefix>.h and <output-prefix>_tables.h\n");
+        return 2;
+    }
+
+    snprintf(types_path, sizeof(types_path), "%s.h", argv[2]);
+    snprintf(tables_path, sizeof(tables_path), "%s_tables.h", argv[2]);
+    types_file = strrchr(types_path, '/') ? strrchr(types_path, '/') + 1 : types_path;
+    tables_file = strrchr(tables_path, '/') ? strrchr(tables_path, '/') + 1 : tables_path;
+
+    if (!parse_file(argv[1])) {
+        fprintf(stderr, "%s: %d error(s), nothing generated\n", argv[1], def.errors);
+        return 1;
+    }
+
+    check_reachability();
+    check_events();
+    check_dead_ends();
+
+    if (def.errors > 0) {
+        fprintf(stderr, "%s: %d error(s), %d warning(s), nothing generated\n",
+                argv[1], def.errors, def.warnings);
+        return 1;
+    }
+
+    if (!emit_types(types_path, types_file) ||
+        !emit_tables(tables_path, tables_file, types_file)) {
+        return 1;
+    }
+
+    printf("%s: %d states, %d events, %d/%d cells populated, %d warning(s)\n",
+           argv[1], def.num_states, def.num_events, def.num_transitions,
+           def.num_states * def.num_events, def.warnings);
+    printf("  -> %s, %s\n", types_path, tables_path);
+    return 0;
+}
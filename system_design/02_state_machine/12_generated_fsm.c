@@ -0,0 +1,346 @@
+/**
+ * 12_generated_fsm.c - Engine Driven by Generated Tables
+ *
+ * The same instance-pointer engine as 07_multi_instance.c, but with no
+ * hand-written enums, names or tables: they all come from
+ * 11_wash_machine.fsm via 11_fsm_compiler. This file only supplies the
+ * context type, the hardware calls and the guard/action bodies.
+ *
+ * Forget to implement a callback named in the .fsm file and the build
+ * fails here; make the machine inconsistent and it fails in the compiler.
+ *
+ * Build:   make 12_generated_fsm   (runs the compiler first)
+ * Run:     ./12_generated_fsm
+ *
+ * Study time: 10 minutes
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "wash_fsm.h"
+
+typedef enum {
+    STATUS_OK = 0,
+    STATUS_ERROR_INVALID_STATE,
+    STATUS_ERROR_INVALID_EVENT,
+    STATUS_ERROR_DOOR_OPEN,
+    STATUS_ERROR_HARDWARE
+} status_t;
+
+typedef enum {
+    PROGRAM_NORMAL,
+    PROGRAM_DELICATE,
+    PROGRAM_HEAVY,
+    PROGRAM_QUICK
+} wash_program_t;
+
+typedef struct {
+    uint16_t fill_time;
+    uint16_t wash_time;
+    uint16_t spin_time;
+    uint8_t motor_speed;
+} program_config_t;
+
+static const program_config_t programs[] = {
+    [PROGRAM_NORMAL]   = {10, 30, 20, 100},
+    [PROGRAM_DELICATE] = {10, 20, 10, 50},
+    [PROGRAM_HEAVY]    = {15, 45, 30, 100},
+    [PROGRAM_QUICK]    = {5,  15, 10, 100}
+};
+
+/* Same 12-byte context as 07_multi_instance.c */
+typedef struct {
+    uint8_t  current_state;
+    uint8_t  previous_state;
+    uint8_t  program;
+    uint8_t  door_open;
+    uint16_t wash_timer;
+    uint16_t spin_timer;
+    uint16_t error_count;
+    uint16_t transitions;
+} wash_machine_t;
+
+/* Prototypes, transition_table, entry/exit/during tables */
+#include "wash_fsm_tables.h"
+
+/* ============================================================================
+ * HARDWARE ABSTRACTION (simulated)
+ * ============================================================================ */
+
+static inline status_t hw_lock_door(wash_machine_t *m)         { (void)m; return STATUS_OK; }
+static inline status_t hw_unlock_door(wash_machine_t *m)       { (void)m; return STATUS_OK; }
+static inline status_t hw_open_water_valve(wash_machine_t *m)  { (void)m; return STATUS_OK; }
+static inline status_t hw_close_water_valve(wash_machine_t *m) { (void)m; return STATUS_OK; }
+static inline status_t hw_start_motor(wash_machine_t *m, uint8_t speed) { (void)m; (void)speed; return STATUS_OK; }
+static inline status_t hw_stop_motor(wash_machine_t *m)        { (void)m; return STATUS_OK; }
+static inline status_t hw_open_drain_valve(wash_machine_t *m)  { (void)m; return STATUS_OK; }
+static inline status_t hw_close_drain_valve(wash_machine_t *m) { (void)m; return STATUS_OK; }
+static inline void     hw_beep(wash_machine_t *m, uint8_t count) { (void)m; (void)count; }
+
+/* ============================================================================
+ * CALLBACKS NAMED IN 11_wash_machine.fsm
+ * ============================================================================ */
+
+static status_t on_enter_idle(wash_machine_t *m) {
+    hw_unlock_door(m);
+    m->wash_timer = 0;
+    m->spin_timer = 0;
+    return STATUS_OK;
+}
+
+static status_t on_enter_filling(wash_machine_t *m) {
+    status_t status;
+
+    if (m->door_open) {
+        m->error_count++;
+        return STATUS_ERROR_DOOR_OPEN;
+    }
+
+    status = hw_lock_door(m);
+    if (status != STATUS_OK) return status;
+
+    return hw_open_water_valve(m);
+}
+
+static status_t on_exit_filling(wash_machine_t *m) {
+    return hw_close_water_valve(m);
+}
+
+static status_t on_enter_washing(wash_machine_t *m) {
+    const program_config_t *config = &programs[m->program];
+    m->wash_timer = config->wash_time;
+    return hw_start_motor(m, config->motor_speed);
+}
+
+static status_t on_exit_washing(wash_machine_t *m) {
+    return hw_stop_motor(m);
+}
+
+static status_t on_enter_draining(wash_machine_t *m) {
+    return hw_open_drain_valve(m);
+}
+
+static status_t on_exit_draining(wash_machine_t *m) {
+    return hw_close_drain_valve(m);
+}
+
+static status_t on_enter_spinning(wash_machine_t *m) {
+    m->spin_timer = programs[m->program].spin_time;
+    return hw_start_motor(m, 100);
+}
+
+static status_t on_exit_spinning(wash_machine_t *m) {
+    return hw_stop_motor(m);
+}
+
+static status_t on_enter_done(wash_machine_t *m) {
+    hw_unlock_door(m);
+    hw_beep(m, 3);
+    return STATUS_OK;
+}
+
+static status_t on_enter_paused(wash_machine_t *m) {
+    hw_stop_motor(m);
+    hw_close_water_valve(m);
+    return STATUS_OK;
+}
+
+static status_t on_enter_error(wash_machine_t *m) {
+    hw_stop_motor(m);
+    hw_close_water_valve(m);
+    hw_close_drain_valve(m);
+    hw_beep(m, 5);
+    return STATUS_OK;
+}
+
+static bool guard_door_closed(wash_machine_t *m) {
+    return !m->door_open;
+}
+
+static status_t action_save_history(wash_machine_t *m) {
+    m->previous_state = m->current_state;
+    return STATUS_OK;
+}
+
+static status_t action_clear_errors(wash_machine_t *m) {
+    m->error_count = 0;
+    return STATUS_OK;
+}
+
+static wash_event_t during_washing(wash_machine_t *m, wash_event_t event) {
+    if (m->wash_timer > 0) {
+        m->wash_timer--;
+    }
+    return (m->wash_timer == 0) ? EVENT_WASH_DONE : event;
+}
+
+static wash_event_t during_spinning(wash_machine_t *m, wash_event_t event) {
+    if (m->spin_timer > 0) {
+        m->spin_timer--;
+    }
+    return (m->spin_timer == 0) ? EVENT_SPIN_DONE : event;
+}
+
+/* ============================================================================
+ * ENGINE (07_multi_instance.c; the tables are generated)
+ * ============================================================================ */
+
+static status_t fsm_transition(wash_machine_t *m, const fsm_transition_t *t) {
+    wash_state_t old_state = m->current_state;
+    wash_state_t new_state = (t->target == STATE_HISTORY)
+                             ? (wash_state_t)m->previous_state : (wash_state_t)t->target;
+    status_t status;
+
+    if (exit_table[old_state]) {
+        status = exit_table[old_state](m);
+        if (status != STATUS_OK) {
+            m->error_count++;
+            return status;
+        }
+    }
+
+    if (t->action) {
+        status = t->action(m);
+        if (status != STATUS_OK) {
+            m->error_count++;
+            return status;
+        }
+    }
+
+    m->current_state = new_state;
+    m->transitions++;
+
+    /* 'entry' is optional in the .fsm grammar: the slot may be NULL */
+    if (!entry_table[new_state]) {
+        return STATUS_OK;
+    }
+
+    status = entry_table[new_state](m);
+    if (status != STATUS_OK) {
+        m->current_state = STATE_ERROR;
+        on_enter_error(m);
+    }
+
+    return status;
+}
+
+static status_t fsm_dispatch(wash_machine_t *m, wash_event_t event) {
+    if (event >= EVENT_MAX) {
+        return STATUS_ERROR_INVALID_EVENT;
+    }
+    if (m->current_state >= STATE_MAX) {
+        return STATUS_ERROR_INVALID_STATE;
+    }
+
+    fsm_during_t during = during_table[m->current_state];
+    if (during) {
+        event = during(m, event);
+    }
+
+    const fsm_transition_t *t = &transition_table[m->current_state][event];
+    if (!t->handled || (t->guard && !t->guard(m))) {
+        return STATUS_OK;
+    }
+
+    return fsm_transition(m, t);
+}
+
+static void wash_machine_init(wash_machine_t *m, wash_program_t program) {
+    memset(m, 0, sizeof(*m));
+    m->current_state = WASH_INITIAL_STATE;
+    m->program = program;
+}
+
+/* Dispatch and print the transition, if any */
+static void run(wash_machine_t *m, wash_event_t event) {
+    wash_state_t before = m->current_state;
+    status_t status = fsm_dispatch(m, event);
+
+    if (m->current_state != before || status != STATUS_OK) {
+        printf("  %-10s --%-10s--> %s%s\n", state_names[before], event_names[event],
+               state_names[m->current_state], status != STATUS_OK ? "  (failed)" : "");
+    }
+}
+
+static void run_ticks(wash_machine_t *m, int ticks) {
+    for (int i = 0; i < ticks; i++) {
+        run(m, EVENT_NONE);
+    }
+}
+
+static void print_table(void) {
+    printf("%-10s", "");
+    for (int e = 0; e < EVENT_MAX; e++) {
+        printf(" %.4s", event_names[e]);
+    }
+    printf("\n");
+
+    for (int s = 0; s < STATE_MAX; s++) {
+        printf("%-10s", state_names[s]);
+        for (int e = 0; e < EVENT_MAX; e++) {
+            const fsm_transition_t *t = &transition_table[s][e];
+            printf(" %.4s", !t->handled ? "   ." :
+                            t->target == STATE_HISTORY ? "HIST" : state_names[t->target]);
+        }
+        printf("\n");
+    }
+}
+
+int main(void) {
+    wash_machine_t m;
+
+    printf("=== State Machine from Generated Tables ===\n\n");
+    printf("Source: 11_wash_machine.fsm -> wash_fsm.h, wash_fsm_tables.h\n");
+    printf("%d states, %d events, transition_table %zu bytes\n\n",
+           STATE_MAX, EVENT_MAX, sizeof(transition_table));
+    print_table();
+
+    printf("\n--- Quick program with pause ---\n");
+    wash_machine_init(&m, PROGRAM_QUICK);
+    run(&m, EVENT_START);
+    run(&m, EVENT_WATER_FULL);
+    run_ticks(&m, 5);
+    run(&m, EVENT_PAUSE);
+    run(&m, EVENT_RESUME);
+    run_ticks(&m, 15);
+    run(&m, EVENT_DRAIN_DONE);
+    run_ticks(&m, 15);
+
+    printf("\n--- Fault during fill ---\n");
+    run(&m, EVENT_START);
+    run(&m, EVENT_ERROR);
+    run(&m, EVENT_START);                  /* Unhandled in ERROR: ignored */
+    run(&m, EVENT_RESET);
+
+    printf("\n--- Door open ---\n");
+    m.door_open = 1;
+    run(&m, EVENT_START);                  /* Guard rejects, no transition */
+    printf("  start ignored, still %s\n", state_names[m.current_state]);
+
+    printf("\nTransitions: %u, errors: %u\n", m.transitions, m.error_count);
+    return 0;
+}
+
+/*
+ * GENERATED TABLES NOTES:
+ *
+ * 1. ONE SOURCE OF TRUTH
+ *    - Enum order, names and table rows cannot drift apart
+ *    - Adding a state = one 'states' word + its transitions
+ *
+ * 2. CHECKED AT BUILD TIME
+ *    - Unreachable states and never-handled events stop the build
+ *    - Typos in state/event names are errors, not silent zero cells
+ *    - A missing callback is a compile error (static prototype, no body)
+ *
+ * 3. NO RUNTIME COST
+ *    - The output is exactly what 06/07 wrote by hand: const tables,
+ *      same engine, same dispatch
+ *
+ * 4. REVIEW THE .fsm, NOT THE .h
+ *    - Generated headers are build artifacts ('make clean' removes them)
+ *    - The .fsm diff is the state-diagram diff
+ */
@@ -0,0 +1,805 @@
+/**
+ * 13_snapshot_restore.c - Snapshot/Restore for Warm Restart
+ *
+ * After a fatal error or a watchdog reset, every version so far boots
+ * into STATE_IDLE: the program, the timers and the error count are gone
+ * and a half-finished wash has to start over (with wet laundry inside).
+ * This version keeps a compact binary snapshot of wash_machine_t:
+ * - 20-byte slot: state, history, program, timers, error count
+ * - Written at every transition (and every few timer ticks)
+ * - Double-buffered: the write goes to the OLDER slot, so the newest
+ *   good snapshot is never overwritten in place
+ * - seq + CRC32 per slot (same commit protocol as
+ *   09_error_handler/06_persistent_log.c), plus range checks on restore
+ * - Restore picks the newest valid slot, re-drives the outputs of that
+ *   state and puts the timers back: microseconds, not a new cycle
+ *
+ * The region is a memory-mapped file standing in for battery-backed RAM
+ * or a reserved flash page.
+ *
+ * Compile: gcc -O2 -std=c11 13_snapshot_restore.c -o snapshot_restore
+ * Run:     ./snapshot_restore
+ *
+ * Study time: 20 minutes
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+typedef enum {
+    STATUS_OK = 0,
+    STATUS_ERROR_INVALID_STATE,
+    STATUS_ERROR_INVALID_EVENT,
+    STATUS_ERROR_DOOR_OPEN,
+    STATUS_ERROR_HARDWARE
+} status_t;
+
+/* ============================================================================
+ * STATE MACHINE DEFINITION (same as 07_multi_instance.c)
+ * ============================================================================ */
+
+typedef enum {
+    STATE_IDLE,
+    STATE_FILLING,
+    STATE_WASHING,
+    STATE_DRAINING,
+    STATE_SPINNING,
+    STATE_DONE,
+    STATE_PAUSED,
+    STATE_ERROR,
+    STATE_MAX,
+    STATE_HISTORY = STATE_MAX
+} wash_state_t;
+
+typedef enum {
+    EVENT_START,
+    EVENT_WATER_FULL,
+    EVENT_WASH_DONE,
+    EVENT_DRAIN_DONE,
+    EVENT_SPIN_DONE,
+    EVENT_PAUSE,
+    EVENT_RESUME,
+    EVENT_STOP,
+    EVENT_ERROR,
+    EVENT_RESET,
+    EVENT_NONE,
+    EVENT_MAX
+} wash_event_t;
+
+typedef enum {
+    PROGRAM_NORMAL,
+    PROGRAM_DELICATE,
+    PROGRAM_HEAVY,
+    PROGRAM_QUICK
+} wash_program_t;
+
+typedef struct {
+    uint16_t fill_time;
+    uint16_t wash_time;
+    uint16_t spin_time;
+    uint8_t motor_speed;
+} program_config_t;
+
+static const program_config_t programs[] = {
+    [PROGRAM_NORMAL]   = {10, 30, 20, 100},
+    [PROGRAM_DELICATE] = {10, 20, 10, 50},
+    [PROGRAM_HEAVY]    = {15, 45, 30, 100},
+    [PROGRAM_QUICK]    = {5,  15, 10, 100}
+};
+
+const char* state_names[] = {
+    "IDLE", "FILLING", "WASHING", "DRAINING",
+    "SPINNING", "DONE", "PAUSED", "ERROR"
+};
+
+/*
+ * Same 12-byte context as 07_multi_instance.c. The snapshot keeps all of
+ * it except door_open (an input, re-read from the sensor on boot) and
+ * transitions (diagnostics).
+ */
+typedef struct {
+    uint8_t  current_state;
+    uint8_t  previous_state;
+    uint8_t  program;
+    uint8_t  door_open;
+    uint16_t wash_timer;
+    uint16_t spin_timer;
+    uint16_t error_count;
+    uint16_t transitions;    /* Per-instance diagnostics (wraps) */
+} wash_machine_t;
+
+/* ============================================================================
+ * HARDWARE ABSTRACTION (simulated)
+ * ============================================================================ */
+
+static inline status_t hw_lock_door(wash_machine_t *m)         { (void)m; return STATUS_OK; }
+static inline status_t hw_unlock_door(wash_machine_t *m)       { (void)m; return STATUS_OK; }
+static inline status_t hw_open_water_valve(wash_machine_t *m)  { (void)m; return STATUS_OK; }
+static inline status_t hw_close_water_valve(wash_machine_t *m) { (void)m; return STATUS_OK; }
+static inline status_t hw_start_motor(wash_machine_t *m, uint8_t speed) { (void)m; (void)speed; return STATUS_OK; }
+static inline status_t hw_stop_motor(wash_machine_t *m)        { (void)m; return STATUS_OK; }
+static inline status_t hw_open_drain_valve(wash_machine_t *m)  { (void)m; return STATUS_OK; }
+static inline status_t hw_close_drain_valve(wash_machine_t *m) { (void)m; return STATUS_OK; }
+static inline void     hw_beep(wash_machine_t *m, uint8_t count) { (void)m; (void)count; }
+
+/* ============================================================================
+ * STATE ACTIONS (instance pointer instead of the global)
+ * ============================================================================ */
+
+static status_t on_enter_idle(wash_machine_t *m) {
+    hw_unlock_door(m);
+    m->wash_timer = 0;
+    m->spin_timer = 0;
+    return STATUS_OK;
+}
+
+static status_t on_enter_filling(wash_machine_t *m) {
+    status_t status;
+
+    if (m->door_open) {
+        m->error_count++;
+        return STATUS_ERROR_DOOR_OPEN;
+    }
+
+    status = hw_lock_door(m);
+    if (status != STATUS_OK) return status;
+
+    return hw_open_water_valve(m);
+}
+
+static status_t on_exit_filling(wash_machine_t *m) {
+    return hw_close_water_valve(m);
+}
+
+static status_t on_enter_washing(wash_machine_t *m) {
+    const program_config_t *config = &programs[m->program];
+    m->wash_timer = config->wash_time;
+    return hw_start_motor(m, config->motor_speed);
+}
+
+static status_t on_exit_washing(wash_machine_t *m) {
+    return hw_stop_motor(m);
+}
+
+static status_t on_enter_draining(wash_machine_t *m) {
+    return hw_open_drain_valve(m);
+}
+
+static status_t on_exit_draining(wash_machine_t *m) {
+    return hw_close_drain_valve(m);
+}
+
+static status_t on_enter_spinning(wash_machine_t *m) {
+    m->spin_timer = programs[m->program].spin_time;
+    return hw_start_motor(m, 100);
+}
+
+static status_t on_exit_spinning(wash_machine_t *m) {
+    return hw_stop_motor(m);
+}
+
+static status_t on_enter_done(wash_machine_t *m) {
+    hw_unlock_door(m);
+    hw_beep(m, 3);
+    return STATUS_OK;
+}
+
+static status_t on_enter_paused(wash_machine_t *m) {
+    hw_stop_motor(m);
+    hw_close_water_valve(m);
+    return STATUS_OK;
+}
+
+static status_t on_enter_error(wash_machine_t *m) {
+    hw_stop_motor(m);
+    hw_close_water_valve(m);
+    hw_close_drain_valve(m);
+    hw_beep(m, 5);
+    return STATUS_OK;
+}
+
+static bool guard_door_closed(wash_machine_t *m) {
+    return !m->door_open;
+}
+
+static status_t action_save_history(wash_machine_t *m) {
+    m->previous_state = m->current_state;
+    return STATUS_OK;
+}
+
+static status_t action_clear_errors(wash_machine_t *m) {
+    m->error_count = 0;
+    return STATUS_OK;
+}
+
+static wash_event_t during_washing(wash_machine_t *m, wash_event_t event) {
+    if (m->wash_timer > 0) {
+        m->wash_timer--;
+    }
+    return (m->wash_timer == 0) ? EVENT_WASH_DONE : event;
+}
+
+static wash_event_t during_spinning(wash_machine_t *m, wash_event_t event) {
+    if (m->spin_timer > 0) {
+        m->spin_timer--;
+    }
+    return (m->spin_timer == 0) ? EVENT_SPIN_DONE : event;
+}
+
+/* ============================================================================
+ * ENGINE TABLES (same as 07_multi_instance.c)
+ * ============================================================================ */
+
+typedef bool (*fsm_guard_t)(wash_machine_t *m);
+typedef status_t (*fsm_action_t)(wash_machine_t *m);
+typedef wash_event_t (*fsm_during_t)(wash_machine_t *m, wash_event_t event);
+
+typedef struct {
+    fsm_guard_t  guard;
+    fsm_action_t action;
+    uint8_t      target;
+    bool         handled;
+} fsm_transition_t;
+
+#define T(to, g, a)  { .guard = (g), .action = (a), .target = (to), .handled = true }
+
+static const fsm_transition_t transition_table[STATE_MAX][EVENT_MAX] = {
+    [STATE_IDLE] = {
+        [EVENT_START]      = T(STATE_FILLING,  guard_door_closed, NULL),
+    },
+    [STATE_FILLING] = {
+        [EVENT_WATER_FULL] = T(STATE_WASHING,  NULL, NULL),
+        [EVENT_PAUSE]      = T(STATE_PAUSED,   NULL, action_save_history),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+        [EVENT_STOP]       = T(STATE_DRAINING, NULL, NULL),
+    },
+    [STATE_WASHING] = {
+        [EVENT_WASH_DONE]  = T(STATE_DRAINING, NULL, NULL),
+        [EVENT_PAUSE]      = T(STATE_PAUSED,   NULL, action_save_history),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+    },
+    [STATE_DRAINING] = {
+        [EVENT_DRAIN_DONE] = T(STATE_SPINNING, NULL, NULL),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+    },
+    [STATE_SPINNING] = {
+        [EVENT_SPIN_DONE]  = T(STATE_DONE,     NULL, NULL),
+        [EVENT_ERROR]      = T(STATE_ERROR,    NULL, NULL),
+    },
+    [STATE_DONE] = {
+        [EVENT_START]      = T(STATE_FILLING,  guard_door_closed, NULL),
+    },
+    [STATE_PAUSED] = {
+        [EVENT_RESUME]     = T(STATE_HISTORY,  NULL, NULL),
+        [EVENT_STOP]       = T(STATE_IDLE,     NULL, NULL),
+    },
+    [STATE_ERROR] = {
+        [EVENT_RESET]      = T(STATE_IDLE,     NULL, action_clear_errors),
+    },
+};
+
+static const fsm_action_t entry_table[STATE_MAX] = {
+    [STATE_IDLE]     = on_enter_idle,
+    [STATE_FILLING]  = on_enter_filling,
+    [STATE_WASHING]  = on_enter_washing,
+    [STATE_DRAINING] = on_enter_draining,
+    [STATE_SPINNING] = on_enter_spinning,
+    [STATE_DONE]     = on_enter_done,
+    [STATE_PAUSED]   = on_enter_paused,
+    [STATE_ERROR]    = on_enter_error,
+};
+
+static const fsm_action_t exit_table[STATE_MAX] = {
+    [STATE_FILLING]  = on_exit_filling,
+    [STATE_WASHING]  = on_exit_washing,
+    [STATE_DRAINING] = on_exit_draining,
+    [STATE_SPINNING] = on_exit_spinning,
+};
+
+static const fsm_during_t during_table[STATE_MAX] = {
+    [STATE_WASHING]  = during_washing,
+    [STATE_SPINNING] = during_spinning,
+};
+
+/* ============================================================================
+ * SNAPSHOT REGION
+ * ============================================================================
+ * On-media layout (fixed-width fields, readable by another build):
+ *
+ *   [ header | slot 0 | slot 1 ]
+ *
+ * Each save goes to the slot NOT holding the newest snapshot. A crash
+ * mid-save can only damage that slot; the other one still holds the
+ * previous good snapshot. A slot with seq == 0 has never been written.
+ */
+
+#define SNAP_MAGIC    0x50414E53u   /* "SNAP" */
+#define SNAP_VERSION  1u
+#define SNAP_SLOTS    2
+
+/* Also checkpoint while a timer runs, so a crash loses at most this much */
+#define SNAP_TIMER_STEP  5
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;
+} snap_header_t;
+
+typedef struct {
+    uint32_t seq;            /* Written LAST - commits the slot */
+    uint32_t crc;            /* CRC32 over seq + payload */
+    uint8_t  current_state;
+    uint8_t  previous_state; /* PAUSED needs it to RESUME */
+    uint8_t  program;
+    uint8_t  reserved;
+    uint16_t wash_timer;
+    uint16_t spin_timer;
+    uint16_t error_count;
+    uint16_t reserved2;
+} snap_slot_t;
+
+typedef struct {
+    snap_header_t header;
+    snap_slot_t   slots[SNAP_SLOTS];
+} snap_image_t;
+
+typedef struct {
+    int           fd;
+    snap_image_t *image;      /* Points into the mapping */
+    uint32_t      next_seq;
+    uint32_t      newest;     /* Slot index of the newest valid snapshot */
+    uint32_t      saves;
+    uint32_t      rejected;   /* Slots discarded at boot */
+} snap_t;
+
+static snap_t snap;
+
+/* ---------------------------------------------------------------------- */
+/* CRC32 (IEEE 802.3, reflected) - same as 06_persistent_log.c             */
+/* ---------------------------------------------------------------------- */
+
+static uint32_t crc_table[256];
+
+static void crc32_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        }
+        crc_table[i] = c;
+    }
+}
+
+static uint32_t crc32(const void *data, size_t len) {
+    const uint8_t *p = data;
+    uint32_t c = 0xFFFFFFFFu;
+    while (len--) {
+        c = crc_table[(c ^ *p++) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+}
+
+static uint32_t slot_crc(const snap_slot_t *slot) {
+    uint32_t c = crc32(&slot->seq, sizeof(slot->seq));
+    const uint8_t *payload = &slot->current_state;
+    size_t len = sizeof(*slot) - offsetof(snap_slot_t, current_state);
+    return c ^ crc32(payload, len);
+}
+
+/*
+ * A CRC proves the slot is the one we wrote, not that what we wrote was
+ * sane. Range-check every field before letting it drive the hardware.
+ */
+static bool slot_valid(const snap_slot_t *slot) {
+    if (slot->seq == 0 || slot->crc != slot_crc(slot)) {
+        return false;
+    }
+    if (slot->current_state >= STATE_MAX || slot->previous_state >= STATE_MAX) {
+        return false;
+    }
+    if (slot->program > PROGRAM_QUICK) {
+        return false;
+    }
+    const program_config_t *config = &programs[slot->program];
+    return slot->wash_timer <= config->wash_time && slot->spin_timer <= config->spin_time;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Open / save                                                             */
+/* ---------------------------------------------------------------------- */
+
+static bool snapshot_open(snap_t *s, const char *path) {
+    s->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (s->fd < 0) {
+        perror("open");
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(s->fd, &st) < 0) {
+        perror("fstat");
+        close(s->fd);
+        return false;
+    }
+
+    bool fresh = ((size_t)st.st_size < sizeof(snap_image_t));
+    if (fresh && ftruncate(s->fd, sizeof(snap_image_t)) < 0) {
+        perror("ftruncate");
+        close(s->fd);
+        return false;
+    }
+
+    void *p = mmap(NULL, sizeof(snap_image_t), PROT_READ | PROT_WRITE, MAP_SHARED, s->fd, 0);
+    if (p == MAP_FAILED) {
+        perror("mmap");
+        close(s->fd);
+        return false;
+    }
+    s->image = p;
+
+    /* Unknown layout: a snapshot from another firmware is not restorable */
+    if (fresh || s->image->header.magic != SNAP_MAGIC ||
+        s->image->header.version != SNAP_VERSION ||
+        s->image->header.slot_count != SNAP_SLOTS ||
+        s->image->header.slot_size != sizeof(snap_slot_t)) {
+        memset(s->image, 0, sizeof(snap_image_t));
+        s->image->header.magic = SNAP_MAGIC;
+        s->image->header.version = SNAP_VERSION;
+        s->image->header.slot_count = SNAP_SLOTS;
+        s->image->header.slot_size = sizeof(snap_slot_t);
+        msync(s->image, sizeof(snap_image_t), MS_SYNC);
+    }
+
+    /* Find the newest valid slot; count the ones we have to throw away */
+    uint32_t newest_seq = 0;
+    s->newest = 0;
+    s->rejected = 0;
+    for (uint32_t i = 0; i < SNAP_SLOTS; i++) {
+        const snap_slot_t *slot = &s->image->slots[i];
+        if (slot->seq == 0) continue;
+        if (!slot_valid(slot)) {
+            s->rejected++;
+            continue;
+        }
+        if (slot->seq > newest_seq) {
+            newest_seq = slot->seq;
+            s->newest = i;
+        }
+    }
+    s->next_seq = newest_seq + 1;
+    s->saves = 0;
+    return true;
+}
+
+static void snapshot_close(snap_t *s) {
+    msync(s->image, sizeof(snap_image_t), MS_SYNC);
+    munmap(s->image, sizeof(snap_image_t));
+    close(s->fd);
+}
+
+/*
+ * Commit protocol (as in 06_persistent_log.c):
+ *   1. seq = 0          -> target slot reads as "empty" while rewritten
+ *   2. payload + crc
+ *   3. seq = next_seq   -> slot becomes the newest
+ * Only after step 3 does 'newest' move, so the next save goes to the
+ * slot we just left.
+ */
+static void snapshot_save(snap_t *s, const wash_machine_t *m) {
+    uint32_t target = (s->image->slots[s->newest].seq == 0) ? s->newest : s->newest ^ 1;
+    snap_slot_t *slot = &s->image->slots[target];
+    snap_slot_t image = {0};
+    uint32_t seq = s->next_seq;
+
+    /* Build the committed image locally so the CRC covers the final seq */
+    image.seq = seq;
+    image.current_state = m->current_state;
+    image.previous_state = m->previous_state;
+    image.program = m->program;
+    image.wash_timer = m->wash_timer;
+    image.spin_timer = m->spin_timer;
+    image.error_count = m->error_count;
+    image.crc = slot_crc(&image);
+
+    slot->seq = 0;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    image.seq = 0;
+    memcpy(slot, &image, sizeof(*slot));
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->seq = seq;
+
+    s->newest = target;
+    s->next_seq++;
+    s->saves++;
+
+    /* ERROR means "reset is likely next": push it to the backing store */
+    if (m->current_state == STATE_ERROR) {
+        msync(s->image, sizeof(snap_image_t), MS_SYNC);
+    }
+}
+
+/*
+ * Test hook: power cut in the middle of a save. seq and CRC land but the
+ * payload only partly does - the slot must be rejected at boot.
+ */
+static void snapshot_save_torn(snap_t *s, const wash_machine_t *m) {
+    snapshot_save(s, m);
+    snap_slot_t *slot = &s->image->slots[s->newest];
+    slot->wash_timer ^= 0x00FF;
+    slot->error_count ^= 0x0F00;
+}
+
+/*
+ * Warm restart. The snapshot says which state we were in, but the
+ * outputs (door lock, valves, motor) were reset with the CPU, so the
+ * state's entry action runs again to re-drive them. Entry actions also
+ * reload the phase timers, so those are restored AFTER it.
+ *
+ * Returns false (and leaves a cold-booted machine) if no slot is valid.
+ */
+static bool snapshot_restore(snap_t *s, wash_machine_t *m) {
+    const snap_slot_t *slot = &s->image->slots[s->newest];
+
+    memset(m, 0, sizeof(*m));
+    m->current_state = STATE_IDLE;
+
+    if (!slot_valid(slot)) {
+        entry_table[STATE_IDLE](m);
+        return false;
+    }
+
+    m->current_state = slot->current_state;
+    m->previous_state = slot->previous_state;
+    m->program = slot->program;
+    m->error_count = slot->error_count;
+
+    if (entry_table[m->current_state](m) != STATUS_OK) {
+        m->current_state = STATE_ERROR;
+        on_enter_error(m);
+        return true;
+    }
+
+    m->wash_timer = slot->wash_timer;
+    m->spin_timer = slot->spin_timer;
+    return true;
+}
+
+/* ============================================================================
+ * ENGINE (07_multi_instance.c + snapshot on every transition)
+ * ============================================================================ */
+
+static status_t fsm_transition(wash_machine_t *m, const fsm_transition_t *t) {
+    wash_state_t old_state = m->current_state;
+    wash_state_t new_state = (t->target == STATE_HISTORY)
+                             ? (wash_state_t)m->previous_state : (wash_state_t)t->target;
+    status_t status;
+
+    if (exit_table[old_state]) {
+        status = exit_table[old_state](m);
+        if (status != STATUS_OK) {
+            m->error_count++;
+            return status;
+        }
+    }
+
+    if (t->action) {
+        status = t->action(m);
+        if (status != STATUS_OK) {
+            m->error_count++;
+            return status;
+        }
+    }
+
+    m->current_state = new_state;
+    m->transitions++;
+
+    status = entry_table[new_state](m);
+    if (status != STATUS_OK) {
+        m->current_state = STATE_ERROR;
+        on_enter_error(m);
+    }
+
+    /* After entry: the snapshot must hold the timers entry just loaded */
+    snapshot_save(&snap, m);
+    return status;
+}
+
+static status_t fsm_dispatch(wash_machine_t *m, wash_event_t event) {
+    if (event >= EVENT_MAX) {
+        return STATUS_ERROR_INVALID_EVENT;
+    }
+    if (m->current_state >= STATE_MAX) {
+        return STATUS_ERROR_INVALID_STATE;
+    }
+
+    fsm_during_t during = during_table[m->current_state];
+    if (during) {
+        event = during(m, event);
+    }
+
+    const fsm_transition_t *t = &transition_table[m->current_state][event];
+    if (!t->handled || (t->guard && !t->guard(m))) {
+        /* No transition, but a running timer is progress worth keeping */
+        if (during && (m->wash_timer + m->spin_timer) % SNAP_TIMER_STEP == 0) {
+            snapshot_save(&snap, m);
+        }
+        return STATUS_OK;
+    }
+
+    return fsm_transition(m, t);
+}
+
+/* ============================================================================
+ * DEMO
+ * ============================================================================ */
+
+static const char *snap_path = "fsm_snapshot.bin";
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void print_machine(const char *label, const wash_machine_t *m) {
+    printf("%s %s, program %u, wash_timer %u, spin_timer %u, errors %u\n",
+           label, state_names[m->current_state], m->program,
+           m->wash_timer, m->spin_timer, m->error_count);
+}
+
+/* Run to DONE on ticks (water/drain sensors fire immediately) */
+static int run_to_done(wash_machine_t *m) {
+    int ticks = 0;
+    while (m->current_state != STATE_DONE && ticks < 1000) {
+        switch (m->current_state) {
+            case STATE_FILLING:  fsm_dispatch(m, EVENT_WATER_FULL); break;
+            case STATE_DRAINING: fsm_dispatch(m, EVENT_DRAIN_DONE); break;
+            case STATE_PAUSED:   fsm_dispatch(m, EVENT_RESUME);     break;
+            default:             fsm_dispatch(m, EVENT_NONE);       break;
+        }
+        ticks++;
+    }
+    return ticks;
+}
+
+/* Child process: start a heavy wash, get 32 ticks in, then "watchdog reset" */
+static void crashing_child(void) {
+    wash_machine_t m;
+
+    if (!snapshot_open(&snap, snap_path)) {
+        _exit(1);
+    }
+    snapshot_restore(&snap, &m);
+    m.program = PROGRAM_HEAVY;
+
+    fsm_dispatch(&m, EVENT_START);
+    fsm_dispatch(&m, EVENT_WATER_FULL);
+    for (int i = 0; i < 32; i++) {
+        fsm_dispatch(&m, EVENT_NONE);
+    }
+
+    print_machine("[child] Before reset:", &m);
+    printf("[child] %u snapshots written, now dying (SIGKILL)...\n", snap.saves);
+    fflush(stdout);
+    raise(SIGKILL);
+}
+
+int main(void) {
+    wash_machine_t m;
+
+    crc32_init();
+    printf("=== State Machine Snapshot/Restore ===\n\n");
+    printf("Snapshot slot: %zu bytes, region: %zu bytes (%d slots)\n\n",
+           sizeof(snap_slot_t), sizeof(snap_image_t), SNAP_SLOTS);
+
+    unlink(snap_path);
+    fflush(stdout);
+
+    /* 1. Crash mid-wash */
+    pid_t pid = fork();
+    if (pid == 0) {
+        crashing_child();
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    if (WIFSIGNALED(status)) {
+        printf("[parent] Child killed by signal %d\n", WTERMSIG(status));
+    }
+
+    /* 2. Warm boot: validate and restore */
+    printf("\n--- Warm boot ---\n");
+    uint64_t t0 = now_ns();
+    if (!snapshot_open(&snap, snap_path)) {
+        return 1;
+    }
+    bool restored = snapshot_restore(&snap, &m);
+    uint64_t t1 = now_ns();
+
+    printf("%s in %.1f us (open + validate + restore)\n",
+           restored ? "Restored" : "No valid snapshot, cold boot", (t1 - t0) / 1e3);
+    print_machine("Resumed in", &m);
+    int ticks = run_to_done(&m);
+    printf("Finished the cycle in %d more ticks\n", ticks);
+
+    wash_machine_t cold = { .current_state = STATE_IDLE, .program = PROGRAM_HEAVY };
+    fsm_dispatch(&cold, EVENT_START);
+    printf("A cold boot would have re-run %d ticks\n", run_to_done(&cold));
+
+    /* 3. Power cut during a save: fall back to the other buffer */
+    printf("\n--- Torn save ---\n");
+    fsm_dispatch(&m, EVENT_START);
+    fsm_dispatch(&m, EVENT_WATER_FULL);
+    for (int i = 0; i < 10; i++) {
+        fsm_dispatch(&m, EVENT_NONE);
+    }
+    print_machine("Last good snapshot:", &m);
+    m.wash_timer -= 3;
+    snapshot_save_torn(&snap, &m);
+    snapshot_close(&snap);
+
+    snapshot_open(&snap, snap_path);
+    restored = snapshot_restore(&snap, &m);
+    printf("Boot: %u slot(s) rejected, %s\n", snap.rejected,
+           restored ? "older slot restored" : "cold boot");
+    print_machine("Resumed in", &m);
+
+    /* 4. Cost of a save: a 20-byte store + CRC, no syscall */
+    const int n = 1000000;
+    t0 = now_ns();
+    for (int i = 0; i < n; i++) {
+        snapshot_save(&snap, &m);
+    }
+    t1 = now_ns();
+    printf("\n=== Save Cost ===\n");
+    printf("%d saves in %.1f ms (%.0f ns/save)\n", n, (t1 - t0) / 1e6, (double)(t1 - t0) / n);
+
+    snapshot_close(&snap);
+
+    printf("\n=== Snapshot Features ===\n");
+    printf("✅ Saved on every transition and every %d timer ticks\n", SNAP_TIMER_STEP);
+    printf("✅ Double buffer: newest good snapshot never overwritten\n");
+    printf("✅ seq + CRC32 + range checks before restore\n");
+    printf("✅ Outputs re-driven by the state's entry action\n");
+    printf("✅ ERROR state msync()s before the expected reset\n");
+
+    return 0;
+}
+
+/*
+ * WARM RESTART CHECKLIST:
+ *
+ * What to save:
+ *   ✅ Only what cannot be re-read: state, history, program, timers, errors
+ *   ✅ Inputs (door sensor) are read fresh after boot
+ *
+ * Crash Consistency:
+ *   ✅ Write the older slot, commit with seq last
+ *   ✅ CRC covers seq + payload
+ *   ✅ Newest valid seq wins; torn slot falls back to the other
+ *
+ * Restore:
+ *   ✅ Validate ranges, not just CRC (a bug can save garbage correctly)
+ *   ✅ Run entry action to re-drive outputs, then restore timers
+ *   ✅ Version the layout: an old snapshot after a firmware update
+ *      is discarded, not misread
+ *
+ * On Real Hardware:
+ *   ✅ Battery-backed RAM / RTC backup registers: same code, no msync
+ *   ✅ Flash: two pages, erase the older one before writing it
+ */
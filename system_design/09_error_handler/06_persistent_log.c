@@ -0,0 +1,466 @@
+/**
+ * 06_persistent_log.c - Persistent Error Log (Memory-Mapped, Crash-Consistent)
+ *
+ * The error log in 04_production.c lives in RAM, so the "System reset"
+ * after a fatal error wipes the very history you need to debug it.
+ * Real products keep the log in battery-backed RAM or flash. On Linux we
+ * stand in for that with a memory-mapped file:
+ * - Appends are plain stores into the mapping (no write()/fsync per entry)
+ * - Each slot carries a sequence number and a CRC32
+ * - A torn or half-written slot fails its CRC and is ignored
+ * - Recovery rebuilds the longest valid run of sequence numbers
+ * - The pages survive kill -9 because they belong to the kernel page cache
+ * - Fatal errors msync() so the log also survives power loss
+ *
+ * Compile: gcc -Wall -std=c11 -D_XOPEN_SOURCE=700 06_persistent_log.c -o persistent_log
+ * Run:     ./persistent_log                    (crash + recovery demo)
+ *          ./persistent_log --read error_log.bin  (reader tool)
+ *
+ * Study time: 25 minutes
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+/* Error types (same as 04_production.c) */
+typedef enum {
+    ERROR_NONE = 0,
+    ERROR_WARNING,
+    ERROR_RECOVERABLE,
+    ERROR_FATAL
+} error_severity_t;
+
+typedef enum {
+    ERROR_SENSOR,
+    ERROR_COMMUNICATION,
+    ERROR_HARDWARE,
+    ERROR_DATA,
+    ERROR_MEMORY
+} error_type_t;
+
+static const char *sev_str[] = {"NONE", "WARNING", "RECOVERABLE", "FATAL"};
+static const char *type_str[] = {"SENSOR", "COMM", "HARDWARE", "DATA", "MEMORY"};
+
+/*
+ * On-media layout. Fixed-width fields only: the file must be readable by
+ * a different build (or a PC-side tool) than the one that wrote it.
+ *
+ *   [ header | slot 0 | slot 1 | ... | slot MAX_ERROR_LOG-1 ]
+ *
+ * A slot with seq == 0 has never been written.
+ */
+#define LOG_MAGIC    0x454C4F47u   /* "ELOG" */
+#define LOG_VERSION  1u
+#define MAX_ERROR_LOG 32
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;
+} log_header_t;
+
+typedef struct {
+    uint32_t seq;          /* Written LAST - commits the slot */
+    uint32_t crc;          /* CRC32 over seq + payload */
+    uint32_t timestamp;
+    uint8_t  severity;
+    uint8_t  type;
+    uint16_t reserved;
+    char     message[64];
+} log_slot_t;
+
+typedef struct {
+    log_header_t header;
+    log_slot_t   slots[MAX_ERROR_LOG];
+} log_image_t;
+
+/* Persistent log handle */
+typedef struct {
+    int          fd;
+    log_image_t *image;       /* Points into the mapping */
+    uint32_t     next_seq;
+    uint32_t     next_index;
+    uint32_t     count;
+    uint32_t     torn_slots;  /* Found during recovery */
+} plog_t;
+
+static plog_t plog;
+static uint32_t sys_ms = 0;
+
+/* ---------------------------------------------------------------------- */
+/* CRC32 (IEEE 802.3, reflected)                                           */
+/* ---------------------------------------------------------------------- */
+
+static uint32_t crc_table[256];
+
+static void crc32_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        }
+        crc_table[i] = c;
+    }
+}
+
+static uint32_t crc32(const void *data, size_t len) {
+    const uint8_t *p = data;
+    uint32_t c = 0xFFFFFFFFu;
+    while (len--) {
+        c = crc_table[(c ^ *p++) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+}
+
+/* CRC covers seq (so a stale payload under a new seq fails) and payload */
+static uint32_t slot_crc(const log_slot_t *slot) {
+    uint32_t c = crc32(&slot->seq, sizeof(slot->seq));
+    const uint8_t *payload = (const uint8_t *)&slot->timestamp;
+    size_t len = sizeof(*slot) - offsetof(log_slot_t, timestamp);
+    return c ^ crc32(payload, len);
+}
+
+static bool slot_valid(const log_slot_t *slot) {
+    return slot->seq != 0 && slot->crc == slot_crc(slot);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Open / recover                                                          */
+/* ---------------------------------------------------------------------- */
+
+/*
+ * Scan every slot, keep the ones whose CRC checks out, and find the
+ * newest one. Walking backwards from it while sequence numbers stay
+ * contiguous gives the valid history; anything outside that run is
+ * either overwritten history or a torn append.
+ */
+static void plog_recover(plog_t *log) {
+    log_slot_t *slots = log->image->slots;
+    uint32_t newest_seq = 0;
+    uint32_t newest_idx = 0;
+
+    log->torn_slots = 0;
+    for (uint32_t i = 0; i < MAX_ERROR_LOG; i++) {
+        if (slots[i].seq == 0) continue;
+        if (!slot_valid(&slots[i])) {
+            log->torn_slots++;
+            continue;
+        }
+        if (slots[i].seq > newest_seq) {
+            newest_seq = slots[i].seq;
+            newest_idx = i;
+        }
+    }
+
+    log->count = 0;
+    if (newest_seq != 0) {
+        uint32_t idx = newest_idx;
+        uint32_t seq = newest_seq;
+        while (log->count < MAX_ERROR_LOG &&
+               slot_valid(&slots[idx]) && slots[idx].seq == seq) {
+            log->count++;
+            if (seq == 1) break;
+            seq--;
+            idx = (idx + MAX_ERROR_LOG - 1) % MAX_ERROR_LOG;
+        }
+    }
+
+    log->next_seq = newest_seq + 1;
+    log->next_index = (newest_seq == 0) ? 0 : (newest_idx + 1) % MAX_ERROR_LOG;
+}
+
+static bool plog_open(plog_t *log, const char *path, bool writable) {
+    int flags = writable ? (O_RDWR | O_CREAT) : O_RDONLY;
+    log->fd = open(path, flags, 0644);
+    if (log->fd < 0) {
+        perror("open");
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(log->fd, &st) < 0) {
+        perror("fstat");
+        close(log->fd);
+        return false;
+    }
+
+    bool fresh = (st.st_size == 0);
+    if (fresh && writable) {
+        if (ftruncate(log->fd, sizeof(log_image_t)) < 0) {
+            perror("ftruncate");
+            close(log->fd);
+            return false;
+        }
+    } else if ((size_t)st.st_size < sizeof(log_image_t)) {
+        fprintf(stderr, "%s: truncated log file\n", path);
+        close(log->fd);
+        return false;
+    }
+
+    int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void *p = mmap(NULL, sizeof(log_image_t), prot, MAP_SHARED, log->fd, 0);
+    if (p == MAP_FAILED) {
+        perror("mmap");
+        close(log->fd);
+        return false;
+    }
+    log->image = p;
+
+    if (fresh && writable) {
+        /* Zero-filled by ftruncate: every slot reads as "never written" */
+        log->image->header.magic = LOG_MAGIC;
+        log->image->header.version = LOG_VERSION;
+        log->image->header.slot_count = MAX_ERROR_LOG;
+        log->image->header.slot_size = sizeof(log_slot_t);
+        msync(log->image, sizeof(log_header_t), MS_SYNC);
+    } else if (log->image->header.magic != LOG_MAGIC ||
+               log->image->header.version != LOG_VERSION ||
+               log->image->header.slot_count != MAX_ERROR_LOG ||
+               log->image->header.slot_size != sizeof(log_slot_t)) {
+        fprintf(stderr, "%s: not an error log (or incompatible layout)\n", path);
+        munmap(log->image, sizeof(log_image_t));
+        close(log->fd);
+        return false;
+    }
+
+    plog_recover(log);
+    return true;
+}
+
+static void plog_close(plog_t *log) {
+    msync(log->image, sizeof(log_image_t), MS_SYNC);
+    munmap(log->image, sizeof(log_image_t));
+    close(log->fd);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Append                                                                  */
+/* ---------------------------------------------------------------------- */
+
+/*
+ * Commit protocol:
+ *   1. seq = 0          -> slot is "empty" while we rewrite it
+ *   2. payload + crc
+ *   3. seq = next_seq   -> slot becomes valid
+ * The release fences stop the compiler/CPU from hoisting the final seq
+ * store above the payload. A crash anywhere before step 3 leaves an empty
+ * slot; a crash that tears step 2 (flash/power loss) fails the CRC.
+ */
+static void log_error(uint32_t timestamp, error_severity_t severity,
+                      error_type_t type, const char *message) {
+    log_slot_t *slot = &plog.image->slots[plog.next_index];
+    log_slot_t entry = {0};
+    uint32_t seq = plog.next_seq;
+
+    /* Build the committed image locally so the CRC covers the final seq */
+    entry.seq = seq;
+    entry.timestamp = timestamp;
+    entry.severity = (uint8_t)severity;
+    entry.type = (uint8_t)type;
+    strncpy(entry.message, message, sizeof(entry.message) - 1);
+    entry.crc = slot_crc(&entry);
+
+    slot->seq = 0;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    entry.seq = 0;
+    memcpy(slot, &entry, sizeof(*slot));
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->seq = seq;
+
+    plog.next_seq++;
+    plog.next_index = (plog.next_index + 1) % MAX_ERROR_LOG;
+    if (plog.count < MAX_ERROR_LOG) {
+        plog.count++;
+    }
+
+    /* Fatal means "reset is next": push the log to the backing store now */
+    if (severity == ERROR_FATAL) {
+        msync(plog.image, sizeof(log_image_t), MS_SYNC);
+    }
+}
+
+/*
+ * Test hook: simulate a power cut in the middle of an append. The new
+ * seq and CRC land but only half of the payload does, which is exactly
+ * what an out-of-order flash program can leave behind.
+ */
+static void log_error_torn(uint32_t timestamp, const char *message) {
+    log_slot_t *slot = &plog.image->slots[plog.next_index];
+    log_slot_t intended = {0};
+
+    intended.seq = plog.next_seq;
+    intended.timestamp = timestamp;
+    intended.severity = ERROR_FATAL;
+    intended.type = ERROR_HARDWARE;
+    strncpy(intended.message, message, sizeof(intended.message) - 1);
+    intended.crc = slot_crc(&intended);
+
+    memcpy(slot, &intended, offsetof(log_slot_t, message) + 8);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Reader tool                                                             */
+/* ---------------------------------------------------------------------- */
+
+static void print_error_log(const plog_t *log) {
+    const log_slot_t *slots = log->image->slots;
+    uint32_t start = (log->next_index + MAX_ERROR_LOG - log->count) % MAX_ERROR_LOG;
+
+    printf("\n=== Error Log (%u entries, %u torn slot(s) at open) ===\n",
+           log->count, log->torn_slots);
+    for (uint32_t i = 0; i < log->count; i++) {
+        const log_slot_t *s = &slots[(start + i) % MAX_ERROR_LOG];
+        printf("#%-4u [%ums] %s/%s: %s\n",
+               s->seq, s->timestamp,
+               s->severity < 4 ? sev_str[s->severity] : "?",
+               s->type < 5 ? type_str[s->type] : "?",
+               s->message);
+    }
+}
+
+static int read_tool(const char *path) {
+    plog_t log;
+    if (!plog_open(&log, path, false)) {
+        return 1;
+    }
+    print_error_log(&log);
+    munmap(log.image, sizeof(log_image_t));
+    close(log.fd);
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Demo                                                                    */
+/* ---------------------------------------------------------------------- */
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* Child process: log some errors, then die mid-append with SIGKILL */
+static void crashing_child(const char *path) {
+    if (!plog_open(&plog, path, true)) {
+        _exit(1);
+    }
+
+    for (int i = 0; i < 10; i++) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Sensor timeout #%d", i + 1);
+        log_error(sys_ms, i % 3 ? ERROR_WARNING : ERROR_RECOVERABLE,
+                  ERROR_SENSOR, msg);
+        sys_ms += 100;
+    }
+
+    printf("[child] Logged 10 entries, now tearing entry 11 and dying...\n");
+    fflush(stdout);
+    log_error_torn(sys_ms, "Brown-out detected - never fully written");
+    raise(SIGKILL);
+}
+
+int main(int argc, char *argv[]) {
+    crc32_init();
+
+    if (argc == 3 && strcmp(argv[1], "--read") == 0) {
+        return read_tool(argv[2]);
+    }
+    if (argc != 1) {
+        fprintf(stderr, "Usage: %s              (crash + recovery demo)\n"
+                        "       %s --read <log>  (reader tool)\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    const char *path = "error_log.bin";
+    const char *bench_path = "error_log_bench.bin";
+    printf("=== Persistent Error Log (mmap, crash-consistent) ===\n\n");
+    unlink(path);
+    fflush(stdout);
+
+    /* 1. Crash a writer mid-append */
+    pid_t pid = fork();
+    if (pid == 0) {
+        crashing_child(path);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    if (WIFSIGNALED(status)) {
+        printf("[parent] Child killed by signal %d\n", WTERMSIG(status));
+    }
+
+    /* 2. Boot again: recover the valid prefix and keep appending */
+    if (!plog_open(&plog, path, true)) {
+        return 1;
+    }
+    printf("[parent] Recovered %u entries, %u torn slot(s) discarded, "
+           "next seq = %u\n", plog.count, plog.torn_slots, plog.next_seq);
+
+    sys_ms = 5000;
+    log_error(sys_ms, ERROR_WARNING, ERROR_COMMUNICATION, "Boot after crash");
+    print_error_log(&plog);
+    plog_close(&plog);
+
+    /*
+     * 3. Append cost: stores into the page cache, no syscalls.
+     * A scratch log, so the recovered demo log above stays readable.
+     */
+    unlink(bench_path);
+    if (!plog_open(&plog, bench_path, true)) {
+        return 1;
+    }
+    const int n = 1000000;
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < n; i++) {
+        log_error((uint32_t)i, ERROR_WARNING, ERROR_DATA, "Out of range");
+    }
+    uint64_t t1 = now_ns();
+    printf("\n=== Append Cost ===\n");
+    printf("%d appends in %.1f ms (%.0f ns/append, no write()/fsync)\n",
+           n, (t1 - t0) / 1e6, (double)(t1 - t0) / n);
+
+    plog_close(&plog);
+    unlink(bench_path);
+
+    printf("\nInspect any time with: %s --read %s\n", argv[0], path);
+
+    printf("\n=== Persistence Features ===\n");
+    printf("✅ Log survives process crash (kill -9)\n");
+    printf("✅ Fatal errors msync() before reset\n");
+    printf("✅ Torn appends rejected by CRC32\n");
+    printf("✅ Sequence numbers order the ring after reboot\n");
+    printf("✅ Append = memory store (no syscall)\n");
+
+    return 0;
+}
+
+/*
+ * PERSISTENCE CHECKLIST:
+ *
+ * Layout:
+ *   ✅ Versioned header (magic, slot count, slot size)
+ *   ✅ Fixed-width fields (portable across builds)
+ *   ✅ seq == 0 means "never written"
+ *
+ * Crash Consistency:
+ *   ✅ seq cleared before rewrite, set last
+ *   ✅ CRC covers seq + payload
+ *   ✅ Recovery keeps the newest contiguous run
+ *
+ * On Real Hardware:
+ *   ✅ Battery-backed RAM: same code, no msync
+ *   ✅ Flash: program payload, then seq word (erase = 0xFF, adjust "empty")
+ *   ✅ Add mutex if several tasks report errors
+ */
@@ -0,0 +1,346 @@
+/**
+ * 07_error_rates.c - Error Analytics: Sliding-Window Error Rates
+ *
+ * error_stats_t in 04_production.c only keeps lifetime counters. "12 comm
+ * errors since boot" says nothing about whether the link is failing NOW.
+ * This version tracks error rates per (type, severity) over three
+ * sliding windows:
+ * - 1 s   (10 buckets x 100 ms)
+ * - 1 min (60 buckets x 1 s)
+ * - 1 h   (60 buckets x 1 min)
+ *
+ * Each window is a fixed ring of buckets with a running total, so:
+ * - Memory is fixed at compile time
+ * - Recording an error is O(1)
+ * - Querying a rate is O(1) (no log scan)
+ * - Threshold triggers let other managers (power, watchdog, health)
+ *   react to rate trends
+ *
+ * Study time: 20 minutes
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Error types (same as 04_production.c) */
+typedef enum {
+    ERROR_NONE = 0,
+    ERROR_WARNING,
+    ERROR_RECOVERABLE,
+    ERROR_FATAL,
+    ERROR_SEVERITY_COUNT
+} error_severity_t;
+
+typedef enum {
+    ERROR_SENSOR,
+    ERROR_COMMUNICATION,
+    ERROR_HARDWARE,
+    ERROR_DATA,
+    ERROR_MEMORY,
+    ERROR_TYPE_COUNT
+} error_type_t;
+
+/* Wildcards for queries and triggers */
+#define ERROR_TYPE_ANY      ERROR_TYPE_COUNT
+#define ERROR_SEVERITY_ANY  ERROR_SEVERITY_COUNT
+
+static const char *sev_str[] = {"NONE", "WARNING", "RECOVERABLE", "FATAL", "ANY"};
+static const char *type_str[] = {"SENSOR", "COMM", "HARDWARE", "DATA", "MEMORY", "ANY"};
+
+static uint32_t sys_ms = 0;
+
+/* ---------------------------------------------------------------------- */
+/* Ring-of-buckets counter                                                 */
+/* ---------------------------------------------------------------------- */
+
+typedef enum {
+    WINDOW_1S = 0,
+    WINDOW_1MIN,
+    WINDOW_1H,
+    WINDOW_COUNT
+} rate_window_id_t;
+
+#define MAX_BUCKETS 60
+
+typedef struct {
+    uint32_t bucket_ms;
+    uint32_t bucket_count;
+} window_def_t;
+
+static const window_def_t window_defs[WINDOW_COUNT] = {
+    [WINDOW_1S]   = { 100,   10 },
+    [WINDOW_1MIN] = { 1000,  60 },
+    [WINDOW_1H]   = { 60000, 60 },
+};
+
+static const char *window_str[] = {"1s", "1min", "1h"};
+
+typedef struct {
+    uint32_t head_epoch;               /* Bucket index (time / bucket_ms) of head */
+    uint32_t total;                    /* Sum of all buckets */
+    uint32_t buckets[MAX_BUCKETS];
+} rate_window_t;
+
+/*
+ * Move the head forward to the bucket that contains now_ms, zeroing
+ * every bucket we skip over. Buckets that fall out of the window are
+ * subtracted from the running total, which keeps queries O(1).
+ */
+static void window_advance(rate_window_t *w, const window_def_t *def, uint32_t now_ms) {
+    uint32_t epoch = now_ms / def->bucket_ms;
+    if (epoch == w->head_epoch) return;
+
+    uint32_t steps = epoch - w->head_epoch;
+    if (steps >= def->bucket_count) {
+        memset(w->buckets, 0, sizeof(w->buckets));
+        w->total = 0;
+    } else {
+        for (uint32_t i = 1; i <= steps; i++) {
+            uint32_t idx = (w->head_epoch + i) % def->bucket_count;
+            w->total -= w->buckets[idx];
+            w->buckets[idx] = 0;
+        }
+    }
+    w->head_epoch = epoch;
+}
+
+static void window_add(rate_window_t *w, const window_def_t *def, uint32_t now_ms) {
+    window_advance(w, def, now_ms);
+    w->buckets[w->head_epoch % def->bucket_count]++;
+    w->total++;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Error rate tracker                                                      */
+/* ---------------------------------------------------------------------- */
+
+/* One set of windows per (type, severity) pair */
+static rate_window_t rates[ERROR_TYPE_COUNT][ERROR_SEVERITY_COUNT][WINDOW_COUNT];
+
+/* Threshold trigger */
+typedef void (*rate_trigger_cb_t)(error_type_t type, error_severity_t severity,
+                                  rate_window_id_t window, uint32_t count);
+
+typedef struct {
+    uint32_t type;         /* error_type_t or ERROR_TYPE_ANY */
+    uint32_t severity;     /* error_severity_t or ERROR_SEVERITY_ANY */
+    rate_window_id_t window;
+    uint32_t threshold;    /* Fire when count in window reaches this */
+    rate_trigger_cb_t callback;
+    bool armed;            /* Re-armed once the rate drops below threshold */
+    uint32_t fire_count;
+} rate_trigger_t;
+
+#define MAX_TRIGGERS 8
+static rate_trigger_t triggers[MAX_TRIGGERS];
+static uint32_t num_triggers = 0;
+
+/* Count of errors in a window; ANY sums over that dimension */
+static uint32_t error_rate_count(uint32_t type, uint32_t severity,
+                                 rate_window_id_t window) {
+    const window_def_t *def = &window_defs[window];
+    uint32_t t0 = (type == ERROR_TYPE_ANY) ? 0 : type;
+    uint32_t t1 = (type == ERROR_TYPE_ANY) ? ERROR_TYPE_COUNT : type + 1;
+    uint32_t s0 = (severity == ERROR_SEVERITY_ANY) ? 0 : severity;
+    uint32_t s1 = (severity == ERROR_SEVERITY_ANY) ? ERROR_SEVERITY_COUNT : severity + 1;
+    uint32_t sum = 0;
+
+    for (uint32_t t = t0; t < t1; t++) {
+        for (uint32_t s = s0; s < s1; s++) {
+            rate_window_t *w = &rates[t][s][window];
+            window_advance(w, def, sys_ms);
+            sum += w->total;
+        }
+    }
+    return sum;
+}
+
+/* Errors per second over a window */
+static float error_rate_per_sec(uint32_t type, uint32_t severity,
+                                rate_window_id_t window) {
+    const window_def_t *def = &window_defs[window];
+    float span_s = (float)(def->bucket_ms * def->bucket_count) / 1000.0f;
+    return (float)error_rate_count(type, severity, window) / span_s;
+}
+
+/* Register a threshold trigger */
+static int error_rate_register_trigger(uint32_t type, uint32_t severity,
+                                       rate_window_id_t window, uint32_t threshold,
+                                       rate_trigger_cb_t callback) {
+    if (num_triggers >= MAX_TRIGGERS) return -1;
+
+    int id = num_triggers++;
+    triggers[id].type = type;
+    triggers[id].severity = severity;
+    triggers[id].window = window;
+    triggers[id].threshold = threshold;
+    triggers[id].callback = callback;
+    triggers[id].armed = true;
+    triggers[id].fire_count = 0;
+
+    return id;
+}
+
+/* Evaluate triggers that match a freshly recorded error */
+static void check_triggers(error_type_t type, error_severity_t severity) {
+    for (uint32_t i = 0; i < num_triggers; i++) {
+        rate_trigger_t *tr = &triggers[i];
+        if (tr->type != ERROR_TYPE_ANY && tr->type != type) continue;
+        if (tr->severity != ERROR_SEVERITY_ANY && tr->severity != severity) continue;
+
+        uint32_t count = error_rate_count(tr->type, tr->severity, tr->window);
+        if (tr->armed && count >= tr->threshold) {
+            tr->armed = false;
+            tr->fire_count++;
+            tr->callback(type, severity, tr->window, count);
+        }
+    }
+}
+
+/* Re-arm triggers whose rate has dropped (call periodically) */
+static void error_rate_poll(void) {
+    for (uint32_t i = 0; i < num_triggers; i++) {
+        rate_trigger_t *tr = &triggers[i];
+        if (!tr->armed &&
+            error_rate_count(tr->type, tr->severity, tr->window) < tr->threshold) {
+            tr->armed = true;
+        }
+    }
+}
+
+/* Record one error occurrence in all windows */
+static void error_rate_record(error_type_t type, error_severity_t severity) {
+    for (int w = 0; w < WINDOW_COUNT; w++) {
+        window_add(&rates[type][severity][w], &window_defs[w], sys_ms);
+    }
+    check_triggers(type, severity);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Error handler (04_production.c, trimmed) + rate hook                    */
+/* ---------------------------------------------------------------------- */
+
+typedef struct {
+    uint32_t warning_count;
+    uint32_t recoverable_count;
+    uint32_t fatal_count;
+} error_stats_t;
+
+static error_stats_t error_stats = {0};
+
+void error_report(error_severity_t severity, error_type_t type, const char *msg) {
+    (void)msg;  /* Logged by 04_production.c; omitted to keep output short */
+
+    error_rate_record(type, severity);
+
+    switch (severity) {
+        case ERROR_WARNING:     error_stats.warning_count++;     break;
+        case ERROR_RECOVERABLE: error_stats.recoverable_count++; break;
+        case ERROR_FATAL:       error_stats.fatal_count++;       break;
+        default: break;
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/* Consumers                                                               */
+/* ---------------------------------------------------------------------- */
+
+/* Health manager: link is flapping, back off the cloud uploader */
+static void on_comm_burst(error_type_t type, error_severity_t severity,
+                          rate_window_id_t window, uint32_t count) {
+    printf("[%6ums] TRIGGER health: %u %s/%s errors in %s -> degrade uplink\n",
+           sys_ms, count, sev_str[severity], type_str[type], window_str[window]);
+}
+
+/* Power manager: a sensor that keeps failing is not worth waking for */
+static void on_sensor_trend(error_type_t type, error_severity_t severity,
+                            rate_window_id_t window, uint32_t count) {
+    (void)severity;
+    printf("[%6ums] TRIGGER power:  %u %s errors in %s -> lower sensor duty cycle\n",
+           sys_ms, count, type_str[type], window_str[window]);
+}
+
+static void print_rates(void) {
+    printf("\n=== Error Rates at %ums ===\n", sys_ms);
+    printf("%-10s %8s %8s %8s\n", "Type", "1s", "1min", "1h");
+    for (uint32_t t = 0; t <= ERROR_TYPE_ANY; t++) {
+        printf("%-10s %8u %8u %8u\n", type_str[t],
+               error_rate_count(t, ERROR_SEVERITY_ANY, WINDOW_1S),
+               error_rate_count(t, ERROR_SEVERITY_ANY, WINDOW_1MIN),
+               error_rate_count(t, ERROR_SEVERITY_ANY, WINDOW_1H));
+    }
+    printf("COMM rate over 1min: %.2f errors/s\n",
+           error_rate_per_sec(ERROR_COMMUNICATION, ERROR_SEVERITY_ANY, WINDOW_1MIN));
+}
+
+int main(void) {
+    printf("=== Error Analytics: Sliding-Window Rates ===\n\n");
+    printf("Memory for all windows: %zu bytes (fixed)\n\n", sizeof(rates));
+
+    /* 5+ comm errors in the last 1 s -> link is flapping */
+    error_rate_register_trigger(ERROR_COMMUNICATION, ERROR_SEVERITY_ANY,
+                                WINDOW_1S, 5, on_comm_burst);
+    /* 20+ sensor errors in the last minute -> sensor degrading */
+    error_rate_register_trigger(ERROR_SENSOR, ERROR_SEVERITY_ANY,
+                                WINDOW_1MIN, 20, on_sensor_trend);
+
+    /* Simulate 3 minutes at 50 ms ticks */
+    for (sys_ms = 0; sys_ms < 180000; sys_ms += 50) {
+        /* Sensor: one timeout every 2 s, then every 500 ms after 60 s */
+        uint32_t sensor_period = (sys_ms < 60000) ? 2000 : 500;
+        if (sys_ms % sensor_period == 0) {
+            error_report(ERROR_WARNING, ERROR_SENSOR, "Sensor timeout");
+        }
+
+        /* Comm: a burst of failures at t=30 s and t=120 s */
+        if ((sys_ms >= 30000 && sys_ms < 30500) ||
+            (sys_ms >= 120000 && sys_ms < 120400)) {
+            error_report(ERROR_RECOVERABLE, ERROR_COMMUNICATION, "Cloud timeout");
+        }
+
+        /* Once a second: re-arm triggers whose rate has recovered */
+        if (sys_ms % 1000 == 0) {
+            error_rate_poll();
+        }
+
+        if (sys_ms == 30450) {
+            print_rates();
+            printf("\n");
+        }
+    }
+    sys_ms -= 50;
+    print_rates();
+
+    printf("\n=== Lifetime Counters (04_production.c view) ===\n");
+    printf("Warnings:    %u\n", error_stats.warning_count);
+    printf("Recoverable: %u\n", error_stats.recoverable_count);
+    printf("Fatal:       %u\n", error_stats.fatal_count);
+
+    printf("\n=== Analytics Features ===\n");
+    printf("✅ Per-type / per-severity rates\n");
+    printf("✅ 1 s, 1 min, 1 h sliding windows\n");
+    printf("✅ Fixed memory, O(1) record and query\n");
+    printf("✅ Threshold triggers with re-arm\n");
+
+    return 0;
+}
+
+/*
+ * ANALYTICS CHECKLIST:
+ *
+ * Counters:
+ *   ✅ Ring of buckets per window
+ *   ✅ Running total (no summing on query)
+ *   ✅ Stale buckets cleared lazily on access
+ *
+ * Accuracy:
+ *   ✅ Resolution = one bucket (100 ms / 1 s / 1 min)
+ *   ✅ Window slides by whole buckets
+ *
+ * Triggers:
+ *   ✅ Type / severity wildcards
+ *   ✅ Fire once, re-arm when rate drops (no callback storms)
+ *   ✅ Consumers: health, power, watchdog managers
+ */
@@ -0,0 +1,439 @@
+/**
+ * 06_predictive_governor.c - Predictive Idle Governor
+ *
+ * power_manager() in 04_production.c picks a state from how long the
+ * system has ALREADY been idle: ACTIVE until 5 s, IDLE until 30 s, SLEEP
+ * until 5 min, then DEEP_SLEEP. Two costs follow:
+ * - Every idle period starts with the thresholds being waited out at a
+ *   higher current, even when the idle period will be long
+ * - An event that arrives just after the step into DEEP_SLEEP pays the
+ *   full wake latency and the full entry/exit energy for nothing
+ *
+ * This version decides at the START of each idle period, like the Linux
+ * "menu" cpuidle governor:
+ * - Each state has entry/exit latency, extra restore charge and current
+ * - Target residency (break-even time) per state is computed from them:
+ *   the shortest idle for which the state uses less charge than the
+ *   next shallower one
+ * - The governor records recent idle intervals, predicts the next one
+ *   (typical interval if the history is consistent, otherwise a safe
+ *   short guess), and picks the deepest state whose residency fits
+ * - A re-evaluation timer promotes to a deeper state if the idle period
+ *   turns out longer than predicted
+ *
+ * The same event trace is run with the threshold policy, the predictive
+ * governor, and an oracle that knows every idle length in advance.
+ *
+ * Compile: gcc -O2 -std=c11 06_predictive_governor.c -o predictive_governor
+ * Run:     ./predictive_governor
+ *
+ * Study time: 30 minutes
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* ============================================================================
+ * POWER STATES
+ * ============================================================================ */
+
+typedef enum {
+    POWER_ACTIVE,
+    POWER_IDLE,
+    POWER_SLEEP,
+    POWER_DEEP_SLEEP,
+    POWER_STATE_COUNT
+} power_state_t;
+
+typedef struct {
+    const char *name;
+    double      current_ma;
+    uint32_t    entry_us;       /* Time at active current to enter */
+    uint32_t    exit_us;        /* Wake latency, also at active current */
+    double      extra_uc;       /* Context save/restore, peripheral re-init */
+    uint64_t    residency_us;   /* Break-even, computed at init */
+} power_state_info_t;
+
+static power_state_info_t states[POWER_STATE_COUNT] = {
+    [POWER_ACTIVE]     = { "ACTIVE",     50.0,     0,    0,   0.0, 0 },
+    [POWER_IDLE]       = { "IDLE",       25.0,     0,    5,   0.0, 0 },
+    [POWER_SLEEP]      = { "SLEEP",       5.0,   100,  200,   0.0, 0 },
+    [POWER_DEEP_SLEEP] = { "DEEP_SLEEP",  0.01, 1000, 3000, 2000.0, 0 },
+};
+
+/* Charge to enter and leave a state, in uC (mA x ms) */
+static double transition_uc(power_state_t s) {
+    const power_state_info_t *p = &states[s];
+    return states[POWER_ACTIVE].current_ma * (p->entry_us + p->exit_us) / 1000.0 + p->extra_uc;
+}
+
+/*
+ * Break-even against the next shallower state:
+ *   transition + I_s * (t - lat) = I_prev * t
+ */
+static void power_states_init(void) {
+    for (int s = POWER_SLEEP; s < POWER_STATE_COUNT; s++) {
+        power_state_info_t *p = &states[s];
+        double lat_ms = (p->entry_us + p->exit_us) / 1000.0;
+        double prev_ma = states[s - 1].current_ma;
+        double t_ms = (transition_uc(s) - p->current_ma * lat_ms) / (prev_ma - p->current_ma);
+
+        p->residency_us = (uint64_t)(t_ms * 1000.0);
+        if (p->residency_us < states[s - 1].residency_us) {
+            p->residency_us = states[s - 1].residency_us;
+        }
+        if (p->residency_us < p->entry_us + p->exit_us) {
+            p->residency_us = p->entry_us + p->exit_us;
+        }
+    }
+}
+
+/* Deepest state worth entering for an idle period of 'idle_us' */
+static power_state_t power_deepest_for(uint64_t idle_us) {
+    power_state_t best = POWER_IDLE;
+    for (int s = POWER_SLEEP; s < POWER_STATE_COUNT; s++) {
+        if (states[s].residency_us <= idle_us) {
+            best = (power_state_t)s;
+        }
+    }
+    return best;
+}
+
+/* ============================================================================
+ * GOVERNOR: IDLE-INTERVAL PREDICTION
+ * ============================================================================ */
+
+#define GOV_HISTORY        8
+#define GOV_MIN_REEVAL_US  2000
+
+typedef struct {
+    uint64_t intervals[GOV_HISTORY];
+    uint32_t next;
+    uint32_t count;
+} governor_t;
+
+static governor_t gov;
+
+void gov_reflect(uint64_t idle_us) {
+    gov.intervals[gov.next] = idle_us;
+    gov.next = (gov.next + 1) % GOV_HISTORY;
+    if (gov.count < GOV_HISTORY) gov.count++;
+}
+
+/*
+ * Typical interval: average the history; if the spread is small
+ * (stddev < avg/6) trust it. Otherwise drop the largest sample and try
+ * again, down to 3/4 of the history. No pattern: predict the shortest
+ * recent interval, and let re-evaluation promote if it is wrong.
+ */
+uint64_t gov_predict(void) {
+    uint64_t limit = UINT64_MAX;
+
+    if (gov.count == 0) {
+        return 0;
+    }
+
+    for (uint32_t round = 0; round <= gov.count / 4; round++) {
+        double sum = 0, sq = 0;
+        uint64_t max = 0;
+        uint32_t n = 0;
+
+        for (uint32_t i = 0; i < gov.count; i++) {
+            uint64_t v = gov.intervals[i];
+            if (v > limit) continue;
+            sum += (double)v;
+            sq += (double)v * (double)v;
+            if (v > max) max = v;
+            n++;
+        }
+        if (n == 0) break;
+
+        double avg = sum / n;
+        double variance = sq / n - avg * avg;
+        if (variance * 36.0 <= avg * avg) {
+            return (uint64_t)avg;
+        }
+        limit = max - 1;
+    }
+
+    uint64_t shortest = UINT64_MAX;
+    for (uint32_t i = 0; i < gov.count; i++) {
+        if (gov.intervals[i] < shortest) shortest = gov.intervals[i];
+    }
+    return shortest;
+}
+
+/* ============================================================================
+ * SIMULATED WORKLOAD
+ * ============================================================================ */
+
+#define MAX_EVENTS 20000
+
+typedef struct {
+    uint64_t at_us;
+    uint32_t work_us;
+} event_t;
+
+static event_t  trace[MAX_EVENTS];
+static uint32_t trace_len;
+static uint32_t rng_state = 12345;
+
+static uint32_t rng_range(uint32_t lo, uint32_t hi) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return lo + (rng_state >> 8) % (hi - lo + 1);
+}
+
+static void trace_add(uint64_t at_us, uint32_t work_us) {
+    if (trace_len < MAX_EVENTS) {
+        trace[trace_len++] = (event_t){ at_us, work_us };
+    }
+}
+
+/*
+ * Three phases, repeated: periodic sampling (1 s, jittered), interactive
+ * bursts (100-400 ms apart with sub-millisecond to 3 ms follow-ups,
+ * pauses of seconds), quiet (minutes).
+ */
+static uint64_t build_trace(void) {
+    uint64_t t = 0;
+
+    for (int cycle = 0; cycle < 2; cycle++) {
+        uint64_t end = t + 10ull * 60 * 1000000;
+        while (t < end) {
+            t += rng_range(980000, 1020000);
+            trace_add(t, 5000);
+        }
+
+        end = t + 5ull * 60 * 1000000;
+        while (t < end) {
+            uint32_t burst = rng_range(10, 30);
+            for (uint32_t i = 0; i < burst; i++) {
+                t += rng_range(100000, 400000);
+                trace_add(t, 15000);
+                /* Display update: SPI/DMA completions shortly after */
+                uint32_t followups = rng_range(2, 6);
+                for (uint32_t j = 0; j < followups; j++) {
+                    t += 15000 + rng_range(200, 3000);
+                    trace_add(t, 300);
+                }
+            }
+            t += rng_range(2000000, 8000000);
+        }
+
+        end = t + 30ull * 60 * 1000000;
+        while (t < end) {
+            t += (uint64_t)rng_range(30, 600) * 1000000;
+            trace_add(t, 20000);
+        }
+    }
+    return t;
+}
+
+/* ============================================================================
+ * POLICY SIMULATION
+ * ============================================================================ */
+
+#define WAKE_LATENCY_BUDGET_US  1000   /* Events must be served within 1 ms */
+
+typedef enum {
+    POLICY_THRESHOLD,
+    POLICY_PREDICTIVE,
+    POLICY_ORACLE
+} policy_t;
+
+typedef struct {
+    double   charge_uc;
+    uint64_t time_us[POWER_STATE_COUNT];
+    uint32_t entries[POWER_STATE_COUNT];
+    uint32_t too_deep;          /* Left before break-even: energy lost */
+    uint32_t too_shallow;       /* A deeper state would have paid off */
+    uint32_t promotions;
+    uint32_t over_budget;       /* Wake latency > WAKE_LATENCY_BUDGET_US */
+    uint64_t wake_latency_us;
+} sim_result_t;
+
+static void spend(sim_result_t *r, power_state_t s, uint64_t us) {
+    r->time_us[s] += us;
+    r->charge_uc += states[s].current_ma * (double)us / 1000.0;
+}
+
+static void enter(sim_result_t *r, power_state_t s) {
+    r->entries[s]++;
+    r->charge_uc += transition_uc(s);
+}
+
+static void wake(sim_result_t *r, power_state_t s) {
+    r->wake_latency_us += states[s].exit_us;
+    if (states[s].exit_us > WAKE_LATENCY_BUDGET_US) {
+        r->over_budget++;
+    }
+}
+
+/* 04_production.c: step down as idle time passes the thresholds */
+static void idle_threshold(sim_result_t *r, uint64_t gap_us) {
+    static const uint64_t steps_us[] = { 5000000, 30000000, 300000000 };
+    uint64_t t = 0;
+    power_state_t s = POWER_ACTIVE;
+
+    for (int i = 0; i < 3 && gap_us > steps_us[i]; i++) {
+        spend(r, s, steps_us[i] - t);
+        t = steps_us[i];
+        s = (power_state_t)(POWER_IDLE + i);
+        enter(r, s);
+    }
+    spend(r, s, gap_us - t);
+    wake(r, s);
+    if (s < power_deepest_for(gap_us)) r->too_shallow++;
+}
+
+static void idle_predictive(sim_result_t *r, uint64_t gap_us) {
+    uint64_t predicted = gov_predict();
+    power_state_t s = power_deepest_for(predicted);
+    uint64_t reeval_us = predicted * 2 > GOV_MIN_REEVAL_US ? predicted * 2 : GOV_MIN_REEVAL_US;
+    uint64_t slept = 0;
+
+    enter(r, s);
+
+    /*
+     * Still asleep at 2x the prediction: the guess was short. Wake on the
+     * re-evaluation timer and assume the rest lasts at least as long as
+     * the idle so far; re-arm at double the time.
+     */
+    while (s != POWER_DEEP_SLEEP && gap_us > reeval_us) {
+        power_state_t deeper = power_deepest_for(reeval_us);
+        if (deeper > s) {
+            spend(r, s, reeval_us - slept);
+            slept = reeval_us;
+            s = deeper;
+            enter(r, s);
+            r->promotions++;
+        }
+        reeval_us *= 2;
+    }
+
+    spend(r, s, gap_us - slept);
+    wake(r, s);
+    if (states[s].residency_us > gap_us - slept) r->too_deep++;
+    if (s < power_deepest_for(gap_us)) r->too_shallow++;
+
+    gov_reflect(gap_us);
+}
+
+static void idle_oracle(sim_result_t *r, uint64_t gap_us) {
+    power_state_t s = power_deepest_for(gap_us);
+    enter(r, s);
+    spend(r, s, gap_us);
+    wake(r, s);
+}
+
+static sim_result_t run_policy(policy_t policy) {
+    sim_result_t r;
+    uint64_t busy_until = 0;
+
+    memset(&r, 0, sizeof(r));
+    memset(&gov, 0, sizeof(gov));
+
+    for (uint32_t i = 0; i < trace_len; i++) {
+        uint64_t gap = trace[i].at_us > busy_until ? trace[i].at_us - busy_until : 0;
+
+        if (gap > 0) {
+            switch (policy) {
+            case POLICY_THRESHOLD:  idle_threshold(&r, gap);  break;
+            case POLICY_PREDICTIVE: idle_predictive(&r, gap); break;
+            case POLICY_ORACLE:     idle_oracle(&r, gap);     break;
+            }
+        }
+        spend(&r, POWER_ACTIVE, trace[i].work_us);
+        busy_until = (gap > 0 ? trace[i].at_us : busy_until) + trace[i].work_us;
+    }
+    return r;
+}
+
+static void print_result(const char *name, const sim_result_t *r, uint64_t total_us) {
+    double avg_ma = r->charge_uc / (total_us / 1000.0);
+    double days = 3000.0 / avg_ma / 24.0;
+
+    printf("%-11s %8.3f %7.0f %9u %9u %7u %9.1f\n", name, avg_ma, days,
+           r->too_deep, r->too_shallow, r->over_budget, r->wake_latency_us / 1000.0);
+}
+
+static void print_residency(const char *name, const sim_result_t *r) {
+    uint64_t total = 0;
+    for (int s = 0; s < POWER_STATE_COUNT; s++) total += r->time_us[s];
+
+    printf("%-11s", name);
+    for (int s = 0; s < POWER_STATE_COUNT; s++) {
+        printf(" %9.1f%%", r->time_us[s] * 100.0 / total);
+    }
+    printf("\n");
+}
+
+int main(void) {
+    printf("=== Predictive Idle Governor vs Threshold Policy ===\n\n");
+
+    power_states_init();
+    printf("%-11s %8s %8s %8s %10s %10s\n", "state", "current", "entry", "exit",
+           "restore", "residency");
+    for (int s = 0; s < POWER_STATE_COUNT; s++) {
+        printf("%-11s %6.2fmA %6uus %6uus %8.0fuC %8.2fms\n", states[s].name,
+               states[s].current_ma, states[s].entry_us, states[s].exit_us,
+               states[s].extra_uc, states[s].residency_us / 1000.0);
+    }
+
+    uint64_t total_us = build_trace();
+    printf("\nTrace: %u events over %.0f min (sampling, interactive, quiet phases)\n\n",
+           trace_len, total_us / 60e6);
+
+    sim_result_t threshold = run_policy(POLICY_THRESHOLD);
+    sim_result_t predictive = run_policy(POLICY_PREDICTIVE);
+    sim_result_t oracle = run_policy(POLICY_ORACLE);
+
+    printf("%-11s %8s %7s %9s %9s %7s %9s\n", "policy", "avg mA", "days",
+           "too deep", "too shal.", ">1ms", "wake (ms)");
+    print_result("threshold", &threshold, total_us);
+    print_result("predictive", &predictive, total_us);
+    print_result("oracle", &oracle, total_us);
+
+    printf("\nTime in state:\n%-11s", "");
+    for (int s = 0; s < POWER_STATE_COUNT; s++) printf(" %10s", states[s].name);
+    printf("\n");
+    print_residency("threshold", &threshold);
+    print_residency("predictive", &predictive);
+    print_residency("oracle", &oracle);
+
+    printf("\nPredictive: %.1fx less charge than threshold, %.0f%% above oracle,\n"
+           "%u promotions after short predictions\n",
+           threshold.charge_uc / predictive.charge_uc,
+           (predictive.charge_uc / oracle.charge_uc - 1.0) * 100.0, predictive.promotions);
+
+    printf("\n=== Predictive Governor Features ===\n");
+    printf("✅ Per-state entry/exit latency and restore charge\n");
+    printf("✅ Break-even residency computed per state\n");
+    printf("✅ Idle-interval history with outlier rejection\n");
+    printf("✅ Deepest state whose residency fits the prediction\n");
+    printf("✅ Re-evaluation timer promotes after short guesses\n");
+    printf("✅ Energy, mispredictions and wake latency reported\n");
+
+    return 0;
+}
+
+/*
+ * PREDICTIVE GOVERNOR NOTES:
+ *
+ * 1. WHY THRESHOLDS WASTE ENERGY
+ *    - Waiting 5 s at 50 mA before the first step costs more than a
+ *      deep sleep entry+exit; the threshold policy pays it every time
+ *
+ * 2. WHAT GOES WRONG WITH PREDICTION
+ *    - Too deep: the event comes before break-even, so the
+ *      transition charge is lost and the full exit latency is paid
+ *    - Too shallow: energy left on the table (promotion limits this)
+ *    - ">1ms" counts wakes slower than the response budget: the
+ *      latency-QoS request (next file) makes that a hard constraint
+ *
+ * 3. BETTER PREDICTIONS
+ *    - Known timers give an upper bound on idle: see the
+ *      sleep-until-next-deadline integration
+ */
@@ -0,0 +1,501 @@
+/**
+ * 07_latency_qos.c - Wake-Latency QoS Constraints on Power States
+ *
+ * power_set_state() in 04_production.c, and the predictive governor in
+ * 06_predictive_governor.c, choose a state from idle time alone. Nothing
+ * stops either from entering DEEP_SLEEP (3 ms to wake) while:
+ * - the alarm is armed and a door contact must be handled within 2 ms
+ * - a console is open and the UART, with a one-byte receive register
+ *   at 115200 baud, must be serviced within 80 us or bytes are lost
+ * Disabling DEEP_SLEEP for good fixes the deadlines and wastes most of
+ * the battery during the hours nobody needs them.
+ *
+ * This version adds a latency QoS API (like Linux cpu_latency_qos):
+ * - power_qos_add(owner, max_wake_latency_us) returns a handle
+ * - power_qos_update() / power_qos_remove() change or drop it
+ * - The tightest active request is cached, so the idle path reads one
+ *   value; only add/update/remove walk the (small) request table
+ * - The governor picks the deepest state that fits the predicted idle
+ *   AND whose exit latency meets the constraint
+ *
+ * Simulated hour with periodic sensing, an armed alarm window and two
+ * console sessions, run with no QoS, a static worst-case cap, and QoS.
+ *
+ * Compile: gcc -O2 -std=c11 07_latency_qos.c -o latency_qos
+ * Run:     ./latency_qos
+ *
+ * Study time: 25 minutes
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Interrupt control (platform-specific) */
+#define DISABLE_INTERRUPTS() /* __disable_irq() */
+#define ENABLE_INTERRUPTS()  /* __enable_irq() */
+
+/* ============================================================================
+ * POWER STATES (model from 06_predictive_governor.c)
+ * ============================================================================ */
+
+typedef enum {
+    POWER_ACTIVE,
+    POWER_IDLE,
+    POWER_SLEEP,
+    POWER_DEEP_SLEEP,
+    POWER_STATE_COUNT
+} power_state_t;
+
+typedef struct {
+    const char *name;
+    double      current_ma;
+    uint32_t    entry_us;
+    uint32_t    exit_us;        /* Wake latency */
+    double      extra_uc;
+    uint64_t    residency_us;   /* Break-even, computed at init */
+} power_state_info_t;
+
+static power_state_info_t states[POWER_STATE_COUNT] = {
+    [POWER_ACTIVE]     = { "ACTIVE",     50.0,     0,    0,    0.0, 0 },
+    [POWER_IDLE]       = { "IDLE",       25.0,     0,    5,    0.0, 0 },
+    [POWER_SLEEP]      = { "SLEEP",       5.0,   100,  200,    0.0, 0 },
+    [POWER_DEEP_SLEEP] = { "DEEP_SLEEP",  0.01, 1000, 3000, 2000.0, 0 },
+};
+
+static double transition_uc(power_state_t s) {
+    const power_state_info_t *p = &states[s];
+    return states[POWER_ACTIVE].current_ma * (p->entry_us + p->exit_us) / 1000.0 + p->extra_uc;
+}
+
+static void power_states_init(void) {
+    for (int s = POWER_SLEEP; s < POWER_STATE_COUNT; s++) {
+        power_state_info_t *p = &states[s];
+        double lat_ms = (p->entry_us + p->exit_us) / 1000.0;
+        double t_ms = (transition_uc(s) - p->current_ma * lat_ms) /
+                      (states[s - 1].current_ma - p->current_ma);
+
+        p->residency_us = (uint64_t)(t_ms * 1000.0);
+        if (p->residency_us < states[s - 1].residency_us) {
+            p->residency_us = states[s - 1].residency_us;
+        }
+        if (p->residency_us < p->entry_us + p->exit_us) {
+            p->residency_us = p->entry_us + p->exit_us;
+        }
+    }
+}
+
+/* ============================================================================
+ * LATENCY QOS
+ * ============================================================================ */
+
+#define QOS_MAX_REQUESTS  8
+#define QOS_NO_LIMIT      UINT32_MAX
+#define QOS_INVALID       (-1)
+
+typedef struct {
+    const char *owner;
+    uint32_t    max_latency_us;
+    bool        active;
+} qos_request_t;
+
+static qos_request_t qos_requests[QOS_MAX_REQUESTS];
+static volatile uint32_t qos_limit_us = QOS_NO_LIMIT;   /* Tightest active */
+
+static void qos_recompute(void) {
+    uint32_t limit = QOS_NO_LIMIT;
+    for (int i = 0; i < QOS_MAX_REQUESTS; i++) {
+        if (qos_requests[i].active && qos_requests[i].max_latency_us < limit) {
+            limit = qos_requests[i].max_latency_us;
+        }
+    }
+    qos_limit_us = limit;
+}
+
+/* Register a constraint. Safe from tasks and ISRs. */
+int power_qos_add(const char *owner, uint32_t max_latency_us) {
+    int handle = QOS_INVALID;
+
+    DISABLE_INTERRUPTS();
+    for (int i = 0; i < QOS_MAX_REQUESTS; i++) {
+        if (!qos_requests[i].active) {
+            qos_requests[i] = (qos_request_t){ owner, max_latency_us, true };
+            handle = i;
+            break;
+        }
+    }
+    if (handle != QOS_INVALID) {
+        qos_recompute();
+    }
+    ENABLE_INTERRUPTS();
+    return handle;
+}
+
+/* The active check is inside the critical section: an ISR could remove
+ * the request between a check outside it and the write */
+bool power_qos_update(int handle, uint32_t max_latency_us) {
+    bool updated = false;
+
+    if (handle < 0 || handle >= QOS_MAX_REQUESTS) {
+        return false;
+    }
+    DISABLE_INTERRUPTS();
+    if (qos_requests[handle].active) {
+        qos_requests[handle].max_latency_us = max_latency_us;
+        qos_recompute();
+        updated = true;
+    }
+    ENABLE_INTERRUPTS();
+    return updated;
+}
+
+void power_qos_remove(int handle) {
+    if (handle < 0 || handle >= QOS_MAX_REQUESTS) {
+        return;
+    }
+    DISABLE_INTERRUPTS();
+    if (qos_requests[handle].active) {
+        qos_requests[handle].active = false;
+        qos_recompute();
+    }
+    ENABLE_INTERRUPTS();
+}
+
+static inline uint32_t power_qos_limit(void) {
+    return qos_limit_us;
+}
+
+/* Deepest state whose wake latency meets 'limit_us' (ACTIVE = poll) */
+static power_state_t power_deepest_allowed(uint32_t limit_us) {
+    power_state_t best = POWER_ACTIVE;
+    for (int s = POWER_IDLE; s < POWER_STATE_COUNT; s++) {
+        if (states[s].exit_us <= limit_us) {
+            best = (power_state_t)s;
+        }
+    }
+    return best;
+}
+
+/* Deepest state whose residency fits 'idle_us' and whose latency fits */
+static power_state_t power_select(uint64_t idle_us, uint32_t limit_us) {
+    power_state_t best = POWER_IDLE;
+    for (int s = POWER_SLEEP; s < POWER_STATE_COUNT; s++) {
+        if (states[s].residency_us <= idle_us) {
+            best = (power_state_t)s;
+        }
+    }
+    power_state_t allowed = power_deepest_allowed(limit_us);
+    return best < allowed ? best : allowed;
+}
+
+/* ============================================================================
+ * GOVERNOR (as in 06_predictive_governor.c)
+ * ============================================================================ */
+
+#define GOV_HISTORY        8
+#define GOV_MIN_REEVAL_US  2000
+
+static uint64_t gov_intervals[GOV_HISTORY];
+static uint32_t gov_next, gov_count;
+
+static void gov_reflect(uint64_t idle_us) {
+    gov_intervals[gov_next] = idle_us;
+    gov_next = (gov_next + 1) % GOV_HISTORY;
+    if (gov_count < GOV_HISTORY) gov_count++;
+}
+
+static uint64_t gov_predict(void) {
+    uint64_t limit = UINT64_MAX, shortest = UINT64_MAX;
+
+    if (gov_count == 0) return 0;
+
+    for (uint32_t round = 0; round <= gov_count / 4; round++) {
+        double sum = 0, sq = 0;
+        uint64_t max = 0;
+        uint32_t n = 0;
+        for (uint32_t i = 0; i < gov_count; i++) {
+            uint64_t v = gov_intervals[i];
+            if (v > limit) continue;
+            sum += (double)v;
+            sq += (double)v * (double)v;
+            if (v > max) max = v;
+            n++;
+        }
+        if (n == 0) break;
+        double avg = sum / n;
+        if ((sq / n - avg * avg) * 36.0 <= avg * avg) return (uint64_t)avg;
+        limit = max - 1;
+    }
+    for (uint32_t i = 0; i < gov_count; i++) {
+        if (gov_intervals[i] < shortest) shortest = gov_intervals[i];
+    }
+    return shortest;
+}
+
+/* ============================================================================
+ * SUBSYSTEMS THAT NEED FAST WAKE-UP
+ * ============================================================================ */
+
+#define ALARM_RESPONSE_US   2000   /* Door contact must be latched in 2 ms */
+#define ALARM_ENTRY_US      150    /* Entry delay: keypad scanned every 150 us */
+#define UART_RX_RESPONSE_US 80     /* 1-byte RX register at 115200 baud */
+
+static int alarm_qos = QOS_INVALID;
+static int uart_qos = QOS_INVALID;
+
+void alarm_arm(void)    { alarm_qos = power_qos_add("alarm", ALARM_RESPONSE_US); }
+void alarm_disarm(void) { power_qos_remove(alarm_qos); alarm_qos = QOS_INVALID; }
+
+/* Door opened while armed: tighten until the code is entered, then relax */
+void alarm_entry_start(void) { power_qos_update(alarm_qos, ALARM_ENTRY_US); }
+void alarm_entry_end(void)   { power_qos_update(alarm_qos, ALARM_RESPONSE_US); }
+
+void console_open(void)  { uart_qos = power_qos_add("uart_rx", UART_RX_RESPONSE_US); }
+void console_close(void) { power_qos_remove(uart_qos); uart_qos = QOS_INVALID; }
+
+/* ============================================================================
+ * SIMULATED HOUR
+ * ============================================================================ */
+
+typedef enum {
+    SRC_SENSOR,
+    SRC_ALARM,
+    SRC_UART,
+    SRC_CONTROL,
+    SRC_COUNT
+} event_source_t;
+
+typedef void (*event_action_t)(void);
+
+typedef struct {
+    uint64_t       at_us;
+    uint32_t       work_us;
+    uint32_t       deadline_us;   /* Max wake latency this event tolerates */
+    event_source_t source;
+    event_action_t action;        /* Arm/disarm, console open/close */
+} event_t;
+
+#define MAX_EVENTS 8000
+#define SIM_US     (60ull * 60 * 1000000)
+#define MIN_US     (60ull * 1000000)
+
+static event_t  trace[MAX_EVENTS];
+static uint32_t trace_len;
+static uint32_t rng_state = 4242;
+
+static uint32_t rng_range(uint32_t lo, uint32_t hi) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return lo + (rng_state >> 8) % (hi - lo + 1);
+}
+
+static void trace_add(uint64_t at_us, uint32_t work_us, uint32_t deadline_us,
+                      event_source_t source, event_action_t action) {
+    if (trace_len < MAX_EVENTS) {
+        trace[trace_len++] = (event_t){ at_us, work_us, deadline_us, source, action };
+    }
+}
+
+static int event_cmp(const void *a, const void *b) {
+    const event_t *x = a, *y = b;
+    return (x->at_us > y->at_us) - (x->at_us < y->at_us);
+}
+
+static void build_trace(void) {
+    uint64_t t;
+
+    /* Temperature sampling every second, all hour */
+    for (t = rng_range(980000, 1020000); t < SIM_US; t += rng_range(980000, 1020000)) {
+        trace_add(t, 5000, 10000, SRC_SENSOR, NULL);
+    }
+
+    /* Alarm armed 5-50 min; door contact every 20-120 s while armed */
+    trace_add(5 * MIN_US, 1000, QOS_NO_LIMIT, SRC_CONTROL, alarm_arm);
+    for (t = 5 * MIN_US + (uint64_t)rng_range(20, 120) * 1000000; t < 50 * MIN_US;
+         t += (uint64_t)rng_range(20, 120) * 1000000) {
+        trace_add(t, 2000, ALARM_RESPONSE_US, SRC_ALARM, NULL);
+    }
+    trace_add(50 * MIN_US, 1000, QOS_NO_LIMIT, SRC_CONTROL, alarm_disarm);
+
+    /* Two console sessions; a command every 0.5-5 s */
+    const uint64_t sessions[][2] = { { 10 * MIN_US, 14 * MIN_US }, { 30 * MIN_US, 33 * MIN_US } };
+    for (int s = 0; s < 2; s++) {
+        trace_add(sessions[s][0], 1000, QOS_NO_LIMIT, SRC_CONTROL, console_open);
+        for (t = sessions[s][0] + 500000; t < sessions[s][1]; t += rng_range(500000, 5000000)) {
+            trace_add(t, 3000, UART_RX_RESPONSE_US, SRC_UART, NULL);
+        }
+        trace_add(sessions[s][1], 1000, QOS_NO_LIMIT, SRC_CONTROL, console_close);
+    }
+
+    qsort(trace, trace_len, sizeof(trace[0]), event_cmp);
+}
+
+typedef enum {
+    POLICY_NO_QOS,        /* 06 governor, latency ignored */
+    POLICY_STATIC_CAP,    /* Worst-case constraint always applied */
+    POLICY_QOS
+} policy_t;
+
+typedef struct {
+    double   charge_uc;
+    uint64_t time_us[POWER_STATE_COUNT];
+    uint32_t misses[SRC_COUNT];
+    uint32_t events[SRC_COUNT];
+} sim_result_t;
+
+static void spend(sim_result_t *r, power_state_t s, uint64_t us) {
+    r->time_us[s] += us;
+    r->charge_uc += states[s].current_ma * (double)us / 1000.0;
+}
+
+/* Governor idle period under a latency limit; returns the state woken from */
+static power_state_t idle_period(sim_result_t *r, uint64_t gap_us, uint32_t limit_us) {
+    uint64_t predicted = gov_predict();
+    power_state_t s = power_select(predicted, limit_us);
+    uint64_t reeval_us = predicted * 2 > GOV_MIN_REEVAL_US ? predicted * 2 : GOV_MIN_REEVAL_US;
+    uint64_t slept = 0;
+
+    r->charge_uc += transition_uc(s);
+    while (s < power_deepest_allowed(limit_us) && gap_us > reeval_us) {
+        power_state_t deeper = power_select(reeval_us, limit_us);
+        if (deeper > s) {
+            spend(r, s, reeval_us - slept);
+            slept = reeval_us;
+            s = deeper;
+            r->charge_uc += transition_uc(s);
+        }
+        reeval_us *= 2;
+    }
+    spend(r, s, gap_us - slept);
+    gov_reflect(gap_us);
+    return s;
+}
+
+static sim_result_t run_policy(policy_t policy) {
+    sim_result_t r;
+    uint64_t busy_until = 0;
+
+    memset(&r, 0, sizeof(r));
+    memset(qos_requests, 0, sizeof(qos_requests));
+    qos_recompute();
+    gov_count = gov_next = 0;
+
+    for (uint32_t i = 0; i < trace_len; i++) {
+        const event_t *e = &trace[i];
+        uint64_t start = e->at_us > busy_until ? e->at_us : busy_until;
+
+        if (e->at_us > busy_until) {
+            uint32_t limit = QOS_NO_LIMIT;
+            if (policy == POLICY_QOS)        limit = power_qos_limit();
+            if (policy == POLICY_STATIC_CAP) limit = UART_RX_RESPONSE_US;
+
+            power_state_t woke_from = idle_period(&r, e->at_us - busy_until, limit);
+            if (states[woke_from].exit_us > e->deadline_us) {
+                r.misses[e->source]++;
+            }
+        }
+        r.events[e->source]++;
+
+        if (e->action != NULL) {
+            e->action();
+        }
+        spend(&r, POWER_ACTIVE, e->work_us);
+        busy_until = start + e->work_us;
+    }
+    return r;
+}
+
+static void print_result(const char *name, const sim_result_t *r) {
+    double avg_ma = r->charge_uc / (SIM_US / 1000.0);
+    uint64_t total = 0;
+    for (int s = 0; s < POWER_STATE_COUNT; s++) total += r->time_us[s];
+
+    printf("%-11s %7.3f %6.0f %6u/%-4u %6u/%-4u %5.1f%% %5.1f%% %5.1f%%\n", name,
+           avg_ma, 3000.0 / avg_ma / 24.0,
+           r->misses[SRC_ALARM], r->events[SRC_ALARM],
+           r->misses[SRC_UART], r->events[SRC_UART],
+           r->time_us[POWER_IDLE] * 100.0 / total,
+           r->time_us[POWER_SLEEP] * 100.0 / total,
+           r->time_us[POWER_DEEP_SLEEP] * 100.0 / total);
+}
+
+int main(void) {
+    printf("=== Wake-Latency QoS for Power State Selection ===\n\n");
+
+    power_states_init();
+
+    /* 1. The API */
+    printf("Constraints and the deepest state they allow:\n");
+    printf("  none:                  limit %10s -> %s\n", "-",
+           states[power_deepest_allowed(power_qos_limit())].name);
+    alarm_arm();
+    printf("  alarm armed:           limit %7u us -> %s\n", power_qos_limit(),
+           states[power_deepest_allowed(power_qos_limit())].name);
+    alarm_entry_start();
+    printf("  door opened (update):  limit %7u us -> %s\n", power_qos_limit(),
+           states[power_deepest_allowed(power_qos_limit())].name);
+    alarm_entry_end();
+    printf("  code entered (update): limit %7u us -> %s\n", power_qos_limit(),
+           states[power_deepest_allowed(power_qos_limit())].name);
+    console_open();
+    printf("  + console open:        limit %7u us -> %s\n", power_qos_limit(),
+           states[power_deepest_allowed(power_qos_limit())].name);
+    int stale = alarm_qos;
+    alarm_disarm();
+    printf("  alarm disarmed:        limit %7u us -> %s\n", power_qos_limit(),
+           states[power_deepest_allowed(power_qos_limit())].name);
+    printf("  update after removal:  %s\n",
+           power_qos_update(stale, ALARM_ENTRY_US) ? "accepted?!" : "rejected");
+    console_close();
+    printf("  console closed:        limit %10s -> %s\n", "-",
+           states[power_deepest_allowed(power_qos_limit())].name);
+
+    /* 2. One simulated hour */
+    build_trace();
+    printf("\nHour: sensor every 1 s, alarm armed 5-50 min, console 10-14 and 30-33 min\n\n");
+
+    sim_result_t no_qos = run_policy(POLICY_NO_QOS);
+    sim_result_t cap = run_policy(POLICY_STATIC_CAP);
+    sim_result_t qos = run_policy(POLICY_QOS);
+
+    printf("%-11s %7s %6s %11s %11s %6s %6s %6s\n", "policy", "avg mA", "days",
+           "alarm miss", "uart miss", "IDLE", "SLEEP", "DEEP");
+    print_result("no QoS", &no_qos);
+    print_result("static cap", &cap);
+    print_result("QoS", &qos);
+
+    printf("\nQoS: no missed deadlines, %.1fx less charge than the static cap,\n"
+           "%.1fx more than ignoring deadlines\n",
+           cap.charge_uc / qos.charge_uc, qos.charge_uc / no_qos.charge_uc);
+    printf("(sensor events, deadline 10 ms, never miss: %u/%u/%u)\n",
+           no_qos.misses[SRC_SENSOR], cap.misses[SRC_SENSOR], qos.misses[SRC_SENSOR]);
+
+    printf("\n=== Latency QoS Features ===\n");
+    printf("✅ power_qos_add / update / remove per subsystem\n");
+    printf("✅ Tightest constraint cached: O(1) on the idle path\n");
+    printf("✅ State choice = min(residency fit, latency fit)\n");
+    printf("✅ Promotion never exceeds the constraint\n");
+    printf("✅ Deadline misses counted per event source\n");
+
+    return 0;
+}
+
+/*
+ * LATENCY QOS NOTES:
+ *
+ * 1. WHO SETS CONSTRAINTS
+ *    - Drivers that lose data if woken late (UART RX without FIFO/DMA,
+ *      USB, audio), and features with response requirements (alarm)
+ *    - Add when the need starts, remove when it ends: a constraint
+ *      left behind silently costs battery
+ *
+ * 2. LATENCY VS RESIDENCY
+ *    - Residency says whether a state SAVES energy for this idle period
+ *    - Latency says whether it is ALLOWED right now
+ *    - The governor needs both: min() of the two choices
+ *
+ * 3. CHEAPER THAN A CONSTRAINT
+ *    - Hardware that buffers while asleep (UART FIFO + wake on RX,
+ *      DMA) relaxes the constraint and lets deeper states back in
+ */
@@ -0,0 +1,471 @@
+/**
+ * 08_sleep_until_deadline.c - Tickless Sleep Until the Next Timer Deadline
+ *
+ * power_manager() in 04_production.c only knows how long it has been
+ * since the last activity. It does not know that the sensor timer from
+ * 05_timer_manager fires in 2 ms, so it can step into DEEP_SLEEP just
+ * before the deadline. The 1 ms tick has to keep running (or a coarse
+ * RTC wake-up replaces it in deep sleep) just to count time, so every
+ * idle millisecond is a wake-up too.
+ *
+ * This version connects the power manager to the timer manager:
+ * - timer_next_deadline_ms() returns the time to the earliest active
+ *   timer (O(MAX_TIMERS), as timer_tick() is)
+ * - The power manager bounds the idle period by that deadline, picks
+ *   the deepest state whose break-even residency fits, and programs a
+ *   one-shot wake-up (RTC/LPTIM compare) EXIT-LATENCY EARLY, so the CPU
+ *   is running again when the deadline arrives
+ * - No tick while asleep: on wake, timer_advance(ms) catches the timer
+ *   list up in one pass instead of one timer_tick() per millisecond
+ * - Asynchronous events (button) still wake early; the plan is redone
+ *
+ * Compared with the tick-driven idle-time policy on the same timers.
+ *
+ * Compile: gcc -O2 -std=c11 08_sleep_until_deadline.c -o sleep_until_deadline
+ * Run:     ./sleep_until_deadline
+ *
+ * Study time: 30 minutes
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* ============================================================================
+ * POWER STATES (model from 06_predictive_governor.c)
+ * ============================================================================ */
+
+typedef enum {
+    POWER_ACTIVE,
+    POWER_IDLE,
+    POWER_SLEEP,
+    POWER_DEEP_SLEEP,
+    POWER_STATE_COUNT
+} power_state_t;
+
+typedef struct {
+    const char *name;
+    double      current_ma;
+    uint32_t    entry_us;
+    uint32_t    exit_us;
+    double      extra_uc;
+    uint64_t    residency_us;
+} power_state_info_t;
+
+static power_state_info_t states[POWER_STATE_COUNT] = {
+    [POWER_ACTIVE]     = { "ACTIVE",     50.0,     0,    0,    0.0, 0 },
+    [POWER_IDLE]       = { "IDLE",       25.0,     0,    5,    0.0, 0 },
+    [POWER_SLEEP]      = { "SLEEP",       5.0,   100,  200,    0.0, 0 },
+    [POWER_DEEP_SLEEP] = { "DEEP_SLEEP",  0.01, 1000, 3000, 2000.0, 0 },
+};
+
+static double transition_uc(power_state_t s) {
+    const power_state_info_t *p = &states[s];
+    return states[POWER_ACTIVE].current_ma * (p->entry_us + p->exit_us) / 1000.0 + p->extra_uc;
+}
+
+static void power_states_init(void) {
+    for (int s = POWER_SLEEP; s < POWER_STATE_COUNT; s++) {
+        power_state_info_t *p = &states[s];
+        double lat_ms = (p->entry_us + p->exit_us) / 1000.0;
+        double t_ms = (transition_uc(s) - p->current_ma * lat_ms) /
+                      (states[s - 1].current_ma - p->current_ma);
+
+        p->residency_us = (uint64_t)(t_ms * 1000.0);
+        if (p->residency_us < states[s - 1].residency_us) {
+            p->residency_us = states[s - 1].residency_us;
+        }
+        if (p->residency_us < p->entry_us + p->exit_us) {
+            p->residency_us = p->entry_us + p->exit_us;
+        }
+    }
+}
+
+/* ============================================================================
+ * SIMULATED TIME AND ENERGY
+ * ============================================================================ */
+
+static uint64_t sim_us;
+
+typedef struct {
+    double   charge_uc;
+    uint64_t time_us[POWER_STATE_COUNT];
+    uint32_t wakeups;            /* Tick interrupts + programmed/async wakes */
+    uint32_t timer_fires;
+    uint32_t late_fires;         /* Handled > 1 ms after the deadline */
+    uint64_t max_late_us;
+    uint64_t max_button_us;      /* Button press to handler */
+} run_stats_t;
+
+static run_stats_t run;
+
+static void spend(power_state_t s, uint64_t us) {
+    run.time_us[s] += us;
+    run.charge_uc += states[s].current_ma * (double)us / 1000.0;
+    sim_us += us;
+}
+
+/* ============================================================================
+ * TIMER MANAGER (05_timer_manager/04_production.c) + DEADLINE QUERY
+ * ============================================================================ */
+
+#define MAX_TIMERS        8
+#define TIMER_INVALID_ID  (-1)
+#define TIMER_NO_DEADLINE UINT32_MAX
+
+typedef void (*timer_callback_t)(void);
+
+typedef enum {
+    TIMER_PERIODIC,
+    TIMER_ONE_SHOT
+} timer_mode_t;
+
+typedef struct {
+    uint32_t         period_ms;
+    uint32_t         remaining_ms;
+    timer_callback_t callback;
+    timer_mode_t     mode;
+    bool             active;
+    const char      *name;
+    uint32_t         fire_count;
+} sw_timer_t;
+
+static sw_timer_t        timers[MAX_TIMERS];
+static volatile uint32_t sys_tick_ms = 0;
+
+static int timer_create(uint32_t period_ms, timer_mode_t mode,
+                        timer_callback_t cb, const char *name) {
+    if (period_ms == 0) return TIMER_INVALID_ID;
+
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        if (timers[i].period_ms == 0) {
+            timers[i] = (sw_timer_t){ period_ms, period_ms, cb, mode, false, name, 0 };
+            return i;
+        }
+    }
+    return TIMER_INVALID_ID;
+}
+
+static void timer_start(int id) {
+    if (id < 0 || id >= MAX_TIMERS || timers[id].period_ms == 0) return;
+    timers[id].remaining_ms = timers[id].period_ms;
+    timers[id].active = true;
+}
+
+static void timer_reset(int id) {
+    timer_start(id);
+}
+
+/* Fire one timer whose countdown reached zero at tick 'due_ms' */
+static void timer_fire(sw_timer_t *t, uint32_t due_ms) {
+    uint64_t late_us = sim_us - (uint64_t)due_ms * 1000;
+
+    t->fire_count++;
+    run.timer_fires++;
+    if (late_us > 1000) run.late_fires++;
+    if (late_us > run.max_late_us) run.max_late_us = late_us;
+
+    if (t->callback) t->callback();
+
+    if (t->mode == TIMER_PERIODIC) {
+        t->remaining_ms = t->period_ms;
+    } else {
+        t->active = false;
+    }
+}
+
+/* One 1 ms tick, as in 05: the SysTick_Handler path */
+static void timer_tick(void) {
+    sys_tick_ms++;
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        if (!timers[i].active) continue;
+        if (--timers[i].remaining_ms == 0) {
+            timer_fire(&timers[i], sys_tick_ms);
+        }
+    }
+}
+
+/*
+ * Milliseconds until the earliest active timer fires, or
+ * TIMER_NO_DEADLINE. The power manager sleeps no longer than this.
+ */
+static uint32_t timer_next_deadline_ms(void) {
+    uint32_t next = TIMER_NO_DEADLINE;
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        if (timers[i].active && timers[i].remaining_ms < next) {
+            next = timers[i].remaining_ms;
+        }
+    }
+    return next;
+}
+
+/*
+ * Tickless catch-up: account for 'ms' elapsed ticks in one pass. A
+ * periodic timer may fire more than once if the CPU was busy for longer
+ * than its period.
+ */
+static void timer_advance(uint32_t ms) {
+    uint32_t base = sys_tick_ms;
+
+    sys_tick_ms += ms;
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        sw_timer_t *t = &timers[i];
+        uint32_t left = ms;
+
+        while (t->active && left >= t->remaining_ms) {
+            left -= t->remaining_ms;
+            timer_fire(t, base + (ms - left));
+        }
+        if (t->active) t->remaining_ms -= left;
+    }
+}
+
+/* ============================================================================
+ * APPLICATION (05 timers, periods for a low-power node)
+ * ============================================================================ */
+
+static volatile bool sensor_pending, led_pending, heartbeat_pending;
+static volatile bool battery_pending, watchdog_pending, debounce_pending;
+
+static void on_sensor(void)    { sensor_pending    = true; }
+static void on_led(void)       { led_pending       = true; }
+static void on_heartbeat(void) { heartbeat_pending = true; }
+static void on_battery(void)   { battery_pending   = true; }
+static void on_watchdog(void)  { watchdog_pending  = true; }
+static void on_debounce(void)  { debounce_pending  = true; }
+
+static int debounce_id;
+
+static void app_init(void) {
+    memset(timers, 0, sizeof(timers));
+    sys_tick_ms = 0;
+    timer_start(timer_create(1000,  TIMER_PERIODIC, on_sensor,    "Sensor-read"));
+    timer_start(timer_create(2000,  TIMER_PERIODIC, on_led,       "LED-blink"));
+    timer_start(timer_create(5000,  TIMER_PERIODIC, on_heartbeat, "Heartbeat"));
+    timer_start(timer_create(10000, TIMER_PERIODIC, on_battery,   "Battery-check"));
+    timer_start(timer_create(2000,  TIMER_PERIODIC, on_watchdog,  "Watchdog-kick"));
+    debounce_id = timer_create(50,  TIMER_ONE_SHOT, on_debounce,  "Btn-debounce");
+}
+
+/* Run pending work; returns true if anything ran */
+static bool app_run_pending(void) {
+    bool ran = false;
+    if (watchdog_pending)  { watchdog_pending  = false; spend(POWER_ACTIVE, 20);    ran = true; }
+    if (led_pending)       { led_pending       = false; spend(POWER_ACTIVE, 50);    ran = true; }
+    if (sensor_pending)    { sensor_pending    = false; spend(POWER_ACTIVE, 10000); ran = true; }
+    if (heartbeat_pending) { heartbeat_pending = false; spend(POWER_ACTIVE, 20000); ran = true; }
+    if (battery_pending)   { battery_pending   = false; spend(POWER_ACTIVE, 5000);  ran = true; }
+    if (debounce_pending)  { debounce_pending  = false; spend(POWER_ACTIVE, 500);   ran = true; }
+    return ran;
+}
+
+/* Button presses: asynchronous, unknown to the timer list */
+#define SIM_MS        (10 * 60 * 1000)
+#define MAX_PRESSES   64
+
+static uint64_t presses_us[MAX_PRESSES];
+static uint32_t num_presses, next_press;
+
+static void build_presses(void) {
+    uint32_t rng = 777;
+    uint64_t t = 0;
+    num_presses = 0;
+    while (num_presses < MAX_PRESSES) {
+        rng = rng * 1664525u + 1013904223u;
+        t += 5000000 + (uint64_t)((rng >> 8) % 25000) * 1000;
+        if (t >= (uint64_t)SIM_MS * 1000) break;
+        presses_us[num_presses++] = t;
+    }
+}
+
+static uint64_t next_press_us(void) {
+    return next_press < num_presses ? presses_us[next_press] : UINT64_MAX;
+}
+
+static void handle_press(void) {
+    uint64_t response = sim_us - presses_us[next_press];
+    if (response > run.max_button_us) run.max_button_us = response;
+    next_press++;
+
+    /* The tick may have been off: bring timers to now before starting one */
+    uint32_t now_ms = (uint32_t)(sim_us / 1000);
+    if (now_ms > sys_tick_ms) timer_advance(now_ms - sys_tick_ms);
+    timer_reset(debounce_id);
+}
+
+/* Sleep in 's' until 'until_us' or an earlier button press. */
+static void sleep_until(power_state_t s, uint64_t until_us) {
+    uint64_t press = next_press_us();
+    uint64_t wake = press < until_us ? press : until_us;
+
+    /* Entry + context save; the exit is spent below as wake latency */
+    run.charge_uc += states[POWER_ACTIVE].current_ma * states[s].entry_us / 1000.0 +
+                     states[s].extra_uc;
+    if (wake > sim_us) spend(s, wake - sim_us);
+    run.wakeups++;
+    spend(POWER_ACTIVE, states[s].exit_us);         /* Wake latency */
+    if (press <= wake) handle_press();
+}
+
+/* ============================================================================
+ * POLICY A: TICK-DRIVEN, IDLE-TIME THRESHOLDS (04 rule, scaled to ms)
+ * ============================================================================
+ * SysTick wakes the CPU every 1 ms in IDLE and SLEEP. In DEEP_SLEEP the
+ * SysTick clock is off; an RTC wakes every 100 ms to catch time up.
+ */
+
+#define TICK_SLEEP_MS       5
+#define TICK_DEEP_MS        500    /* About DEEP_SLEEP break-even */
+#define RTC_WAKE_MS         100
+
+static void run_tick_policy(void) {
+    uint64_t last_activity_us = 0;
+    uint64_t end_us = (uint64_t)SIM_MS * 1000;
+
+    while (sim_us < end_us) {
+        if (app_run_pending()) {
+            last_activity_us = sim_us;
+        }
+        uint32_t now_ms = (uint32_t)(sim_us / 1000);
+        while (sys_tick_ms < now_ms) timer_tick();        /* Ticks while busy */
+        if (sensor_pending || led_pending || heartbeat_pending ||
+            battery_pending || watchdog_pending || debounce_pending) {
+            continue;
+        }
+
+        uint64_t idle_ms = (sim_us - last_activity_us) / 1000;
+        power_state_t s = idle_ms >= TICK_DEEP_MS  ? POWER_DEEP_SLEEP :
+                          idle_ms >= TICK_SLEEP_MS ? POWER_SLEEP : POWER_IDLE;
+        uint32_t step_ms = s == POWER_DEEP_SLEEP ? RTC_WAKE_MS : 1;
+
+        sleep_until(s, (uint64_t)(sys_tick_ms + step_ms) * 1000);
+        if (s == POWER_DEEP_SLEEP) {
+            while (sys_tick_ms < (uint32_t)(sim_us / 1000)) timer_tick();
+        } else {
+            timer_tick();
+        }
+    }
+}
+
+/* ============================================================================
+ * POLICY B: TICKLESS, SLEEP UNTIL THE NEXT DEADLINE
+ * ============================================================================ */
+
+/* Deepest state that pays off within, and wakes in time for, 'bound_us' */
+static power_state_t power_select_bounded(uint64_t bound_us) {
+    power_state_t best = POWER_IDLE;
+    for (int s = POWER_SLEEP; s < POWER_STATE_COUNT; s++) {
+        if (states[s].residency_us <= bound_us &&
+            states[s].entry_us + states[s].exit_us <= bound_us) {
+            best = (power_state_t)s;
+        }
+    }
+    return best;
+}
+
+static void power_idle_until_deadline(void) {
+    uint32_t next_ms = timer_next_deadline_ms();
+    uint64_t deadline_us = next_ms == TIMER_NO_DEADLINE
+                         ? UINT64_MAX : (uint64_t)(sys_tick_ms + next_ms) * 1000;
+    uint64_t bound_us = deadline_us - sim_us;
+    power_state_t s = power_select_bounded(bound_us);
+
+    /* Program the wake-up exit-latency early: running at the deadline */
+    sleep_until(s, deadline_us - states[s].exit_us);
+}
+
+static void run_tickless_policy(void) {
+    uint64_t end_us = (uint64_t)SIM_MS * 1000;
+
+    while (sim_us < end_us) {
+        app_run_pending();
+        uint32_t now_ms = (uint32_t)(sim_us / 1000);
+        if (now_ms > sys_tick_ms) timer_advance(now_ms - sys_tick_ms);
+        if (sensor_pending || led_pending || heartbeat_pending ||
+            battery_pending || watchdog_pending || debounce_pending) {
+            continue;
+        }
+        power_idle_until_deadline();
+    }
+}
+
+/* ============================================================================
+ * MAIN
+ * ============================================================================ */
+
+static run_stats_t simulate(void (*policy)(void)) {
+    memset(&run, 0, sizeof(run));
+    sim_us = 0;
+    next_press = 0;
+    app_init();
+    policy();
+    return run;
+}
+
+static void print_stats(const char *name, const run_stats_t *r) {
+    double avg_ma = r->charge_uc / (sim_us / 1000.0);
+    uint64_t total = 0;
+    for (int s = 0; s < POWER_STATE_COUNT; s++) total += r->time_us[s];
+
+    printf("%-10s %7.3f %8u %6u/%-5u %8.2f %8.2f %5.1f%% %5.1f%%\n", name, avg_ma,
+           r->wakeups, r->late_fires, r->timer_fires, r->max_late_us / 1000.0,
+           r->max_button_us / 1000.0,
+           r->time_us[POWER_SLEEP] * 100.0 / total,
+           r->time_us[POWER_DEEP_SLEEP] * 100.0 / total);
+}
+
+int main(void) {
+    printf("=== Power Manager + Timer Deadlines: Sleep Until Next Event ===\n\n");
+
+    power_states_init();
+    build_presses();
+    printf("Timers: sensor 1 s, LED 2 s, watchdog 2 s, heartbeat 5 s, battery 10 s\n");
+    printf("Button: %u presses in %d min (50 ms debounce timer)\n", num_presses, SIM_MS / 60000);
+    printf("Break-even: SLEEP %.2f ms, DEEP_SLEEP %.0f ms\n\n",
+           states[POWER_SLEEP].residency_us / 1000.0,
+           states[POWER_DEEP_SLEEP].residency_us / 1000.0);
+
+    run_stats_t tick = simulate(run_tick_policy);
+    uint32_t tick_ms = sys_tick_ms;
+    run_stats_t tickless = simulate(run_tickless_policy);
+
+    printf("%-10s %7s %8s %12s %8s %8s %6s %6s\n", "policy", "avg mA", "wakeups",
+           "late fires", "max late", "button", "SLEEP", "DEEP");
+    printf("%-10s %7s %8s %12s %8s %8s %6s %6s\n", "", "", "", "(>1 ms)", "(ms)", "(ms)", "", "");
+    print_stats("tick", &tick);
+    print_stats("tickless", &tickless);
+
+    printf("\nTickless: %.1fx less charge, %.0fx fewer wake-ups over %u ms\n",
+           tick.charge_uc / tickless.charge_uc,
+           (double)tick.wakeups / tickless.wakeups, tick_ms);
+
+    printf("\n=== Sleep-Until-Deadline Features ===\n");
+    printf("✅ timer_next_deadline_ms() query on the timer manager\n");
+    printf("✅ Idle bounded by the next deadline, deepest state that fits\n");
+    printf("✅ Wake-up programmed exit-latency early: timers fire on time\n");
+    printf("✅ No tick while asleep; timer_advance() catches up in one pass\n");
+    printf("✅ Async events (button) still wake and re-plan\n");
+
+    return 0;
+}
+
+/*
+ * SLEEP-UNTIL-DEADLINE NOTES:
+ *
+ * 1. WHY THE TICK POLICY IS LATE
+ *    - It enters DEEP_SLEEP on idle time alone, then learns about the
+ *      time only at the next RTC wake (100 ms) plus the exit latency
+ *
+ * 2. WHY IT WASTES ENERGY
+ *    - Each 1 ms tick in SLEEP costs a full exit + entry
+ *
+ * 3. THE BOUND IS AN UPPER LIMIT
+ *    - Asynchronous events (GPIO, UART RX) can come earlier. Combine the
+ *      deadline with the 06 governor's prediction: idle = min(both)
+ *
+ * 4. THE TIMERS DECIDE THE DEPTH
+ *    - With the 05 demo's 100 ms watchdog kick, no idle period reaches
+ *      DEEP_SLEEP break-even; lengthen periods or align them so they
+ *      fire together (timer slack/coalescing)
+ */
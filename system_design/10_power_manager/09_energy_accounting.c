@@ -0,0 +1,442 @@
+/**
+ * 09_energy_accounting.c - Energy Accounting per Subsystem and Wake Source
+ *
+ * power_print_stats() in 04_production.c turns time-in-state into ONE
+ * average current using hard-coded 50/25/5/0.01 mA. It cannot say WHO
+ * spent the charge: the radio heartbeat? the LCD backlight left on after
+ * a button press? the sensor timer waking the CPU every second? Without
+ * that, nobody knows which optimization is worth doing, or whether one
+ * worked.
+ *
+ * This version adds an accounting layer under the power manager:
+ * - A configurable current model: per CPU power state, per wake-up
+ *   (entry + exit + restore charge), per peripheral
+ * - CPU charge goes to the subsystem the CPU is working for
+ *   (energy_begin/energy_end), sleep floor to SYSTEM
+ * - Peripheral charge goes to the subsystem that switched it on
+ * - power_activity(source) records WHO woke the system: per source,
+ *   the wake-up count, the wake-up charge, and the charge of the whole
+ *   awake episode it started
+ * - Cumulative samples at a fixed period, exported as CSV for plotting
+ *
+ * A 30 minute simulation of a sensor node is accounted, then re-run
+ * with the two optimizations the report points to, and compared.
+ *
+ * Compile: gcc -O2 -std=c11 09_energy_accounting.c -o energy_accounting
+ * Run:     ./energy_accounting   (writes energy_timeseries.csv)
+ *
+ * Study time: 30 minutes
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* ============================================================================
+ * MODEL
+ * ============================================================================ */
+
+typedef enum {
+    POWER_ACTIVE,
+    POWER_IDLE,
+    POWER_SLEEP,
+    POWER_DEEP_SLEEP,
+    POWER_STATE_COUNT
+} power_state_t;
+
+typedef enum {
+    SUBSYS_SYSTEM,      /* Sleep floor, anything unattributed */
+    SUBSYS_SENSOR,
+    SUBSYS_RADIO,
+    SUBSYS_UI,
+    SUBSYS_LOGGER,
+    SUBSYS_COUNT
+} subsys_t;
+
+typedef enum {
+    PERIPH_ADC,
+    PERIPH_RADIO_TX,
+    PERIPH_LCD_BACKLIGHT,
+    PERIPH_FLASH,
+    PERIPH_COUNT
+} periph_t;
+
+static const char *state_names[POWER_STATE_COUNT] = { "ACTIVE", "IDLE", "SLEEP", "DEEP_SLEEP" };
+static const char *subsys_names[SUBSYS_COUNT] = { "system", "sensor", "radio", "ui", "logger" };
+
+/* All currents in mA, charges in uC (mA x ms) */
+typedef struct {
+    double state_ma[POWER_STATE_COUNT];
+    double wake_uc[POWER_STATE_COUNT];    /* Entry + exit + restore */
+    double periph_ma[PERIPH_COUNT];
+} energy_model_t;
+
+static const energy_model_t board_model = {
+    .state_ma  = { [POWER_ACTIVE] = 50.0, [POWER_IDLE] = 25.0,
+                   [POWER_SLEEP] = 5.0,   [POWER_DEEP_SLEEP] = 0.01 },
+    .wake_uc   = { [POWER_IDLE] = 0.25,   [POWER_SLEEP] = 15.0,
+                   [POWER_DEEP_SLEEP] = 2200.0 },
+    .periph_ma = { [PERIPH_ADC] = 1.5,    [PERIPH_RADIO_TX] = 12.0,
+                   [PERIPH_LCD_BACKLIGHT] = 8.0, [PERIPH_FLASH] = 4.0 },
+};
+
+/* ============================================================================
+ * ENERGY ACCOUNTING
+ * ============================================================================ */
+
+#define ENERGY_SAMPLE_US   (10 * 1000000ull)
+#define ENERGY_MAX_SAMPLES 512
+
+typedef struct {
+    /* As a consumer */
+    uint64_t cpu_us;
+    double   cpu_uc;
+    double   periph_uc;
+    /* As a wake source */
+    uint32_t wakeups;
+    double   wake_uc;
+    double   episode_uc;        /* Everything spent while awake because of it */
+} energy_account_t;
+
+typedef struct {
+    uint64_t t_us;
+    double   subsys_uc[SUBSYS_COUNT];
+} energy_sample_t;
+
+typedef struct {
+    const energy_model_t *model;
+    uint64_t      now_us;
+    power_state_t state;
+    subsys_t      context;          /* Who the CPU is working for */
+    subsys_t      wake_source;      /* Who started this awake episode */
+    bool          periph_on[PERIPH_COUNT];
+    subsys_t      periph_owner[PERIPH_COUNT];
+
+    energy_account_t acct[SUBSYS_COUNT];
+    uint64_t      state_us[POWER_STATE_COUNT];
+    double        state_uc[POWER_STATE_COUNT];
+    double        total_uc;
+
+    uint64_t        next_sample_us;
+    energy_sample_t samples[ENERGY_MAX_SAMPLES];
+    uint32_t        num_samples;
+} energy_t;
+
+static energy_t energy;
+
+void energy_init(const energy_model_t *model) {
+    memset(&energy, 0, sizeof(energy));
+    energy.model = model;
+    energy.state = POWER_ACTIVE;
+    energy.next_sample_us = ENERGY_SAMPLE_US;
+}
+
+static double energy_subsys_total(subsys_t s) {
+    return energy.acct[s].cpu_uc + energy.acct[s].periph_uc + energy.acct[s].wake_uc;
+}
+
+/* Integrate 'dt_us' at the current state, context and peripherals */
+static void energy_integrate(uint64_t dt_us) {
+    const energy_model_t *m = energy.model;
+    double ms = dt_us / 1000.0;
+    double cpu_uc = m->state_ma[energy.state] * ms;
+    subsys_t cpu_owner = energy.state == POWER_ACTIVE ? energy.context : SUBSYS_SYSTEM;
+    double spent = cpu_uc;
+
+    energy.acct[cpu_owner].cpu_uc += cpu_uc;
+    if (energy.state == POWER_ACTIVE) energy.acct[cpu_owner].cpu_us += dt_us;
+    energy.state_us[energy.state] += dt_us;
+    energy.state_uc[energy.state] += cpu_uc;
+
+    for (int p = 0; p < PERIPH_COUNT; p++) {
+        if (energy.periph_on[p]) {
+            double uc = m->periph_ma[p] * ms;
+            energy.acct[energy.periph_owner[p]].periph_uc += uc;
+            spent += uc;
+        }
+    }
+    if (energy.state == POWER_ACTIVE) {
+        energy.acct[energy.wake_source].episode_uc += spent;
+    }
+    energy.total_uc += spent;
+    energy.now_us += dt_us;
+}
+
+/* Bring the books up to 'now_us', taking samples on the way */
+void energy_update(uint64_t now_us) {
+    while (energy.next_sample_us <= now_us) {
+        energy_integrate(energy.next_sample_us - energy.now_us);
+        if (energy.num_samples < ENERGY_MAX_SAMPLES) {
+            energy_sample_t *smp = &energy.samples[energy.num_samples++];
+            smp->t_us = energy.now_us;
+            for (int s = 0; s < SUBSYS_COUNT; s++) {
+                smp->subsys_uc[s] = energy_subsys_total((subsys_t)s);
+            }
+        }
+        energy.next_sample_us += ENERGY_SAMPLE_US;
+    }
+    energy_integrate(now_us - energy.now_us);
+}
+
+void energy_begin(uint64_t now_us, subsys_t who) {
+    energy_update(now_us);
+    energy.context = who;
+}
+
+void energy_end(uint64_t now_us) {
+    energy_update(now_us);
+    energy.context = SUBSYS_SYSTEM;
+}
+
+void periph_on(uint64_t now_us, periph_t p, subsys_t owner) {
+    energy_update(now_us);
+    energy.periph_on[p] = true;
+    energy.periph_owner[p] = owner;
+}
+
+void periph_off(uint64_t now_us, periph_t p) {
+    energy_update(now_us);
+    energy.periph_on[p] = false;
+}
+
+/*
+ * A peripheral burst that ran without the CPU (timer-triggered ADC
+ * conversions while asleep): charge it to 'owner', no time advance.
+ */
+void periph_charge(periph_t p, subsys_t owner, uint64_t on_us) {
+    double uc = energy.model->periph_ma[p] * on_us / 1000.0;
+    energy.acct[owner].periph_uc += uc;
+    energy.total_uc += uc;
+}
+
+void power_enter(uint64_t now_us, power_state_t s) {
+    energy_update(now_us);
+    energy.state = s;
+}
+
+/* Wake-up caused by 'source': it pays the transition and owns the episode */
+void power_activity(uint64_t now_us, subsys_t source) {
+    energy_update(now_us);
+    if (energy.state != POWER_ACTIVE) {
+        double uc = energy.model->wake_uc[energy.state];
+        energy.acct[source].wakeups++;
+        energy.acct[source].wake_uc += uc;
+        energy.acct[source].episode_uc += uc;
+        energy.state_uc[energy.state] += uc;
+        energy.total_uc += uc;
+        energy.state = POWER_ACTIVE;
+        energy.wake_source = source;
+    }
+}
+
+/* Cumulative charge per subsystem, one row per sample period */
+void energy_export_csv(FILE *out) {
+    fprintf(out, "time_s");
+    for (int s = 0; s < SUBSYS_COUNT; s++) fprintf(out, ",%s_uC", subsys_names[s]);
+    fprintf(out, "\n");
+    for (uint32_t i = 0; i < energy.num_samples; i++) {
+        fprintf(out, "%.0f", energy.samples[i].t_us / 1e6);
+        for (int s = 0; s < SUBSYS_COUNT; s++) {
+            fprintf(out, ",%.1f", energy.samples[i].subsys_uc[s]);
+        }
+        fprintf(out, "\n");
+    }
+}
+
+void energy_report(void) {
+    double total_ms = energy.now_us / 1000.0;
+
+    printf("%-8s %9s %8s %9s %9s %7s | %7s %9s %10s\n", "subsys", "cpu ms", "cpu uC",
+           "periph uC", "wake uC", "share", "wakes", "uC/wake", "episode uC");
+    for (int s = 0; s < SUBSYS_COUNT; s++) {
+        const energy_account_t *a = &energy.acct[s];
+        printf("%-8s %9.1f %8.0f %9.0f %9.0f %6.1f%% | %7u %9.1f %10.0f\n", subsys_names[s],
+               a->cpu_us / 1000.0, a->cpu_uc, a->periph_uc, a->wake_uc,
+               energy_subsys_total((subsys_t)s) * 100.0 / energy.total_uc,
+               a->wakeups, a->wakeups ? a->episode_uc / a->wakeups : 0.0, a->episode_uc);
+    }
+    printf("States:");
+    for (int s = 0; s < POWER_STATE_COUNT; s++) {
+        printf(" %s %.1f%%", state_names[s], energy.state_us[s] * 100.0 / energy.now_us);
+    }
+    printf("\nAverage %.3f mA -> %.0f days on 3000 mAh\n",
+           energy.total_uc / total_ms, 3000.0 / (energy.total_uc / total_ms) / 24.0);
+}
+
+/* ============================================================================
+ * SIMULATED SENSOR NODE
+ * ============================================================================ */
+
+#define SIM_US            (30ull * 60 * 1000000)
+#define DEEP_SLEEP_MIN_US 500000     /* Break-even of DEEP_SLEEP vs SLEEP */
+#define NO_EVENT          UINT64_MAX
+
+typedef struct {
+    uint32_t sensor_batch;      /* Samples per CPU wake-up (ADC + DMA) */
+    uint32_t heartbeat_ms;
+    uint32_t radio_tx_us;
+    uint32_t backlight_ms;
+} node_config_t;
+
+static uint64_t now;
+
+static void busy(subsys_t who, uint32_t cpu_us) {
+    energy_begin(now, who);
+    now += cpu_us;
+    energy_end(now);
+}
+
+static void sensor_task(const node_config_t *cfg) {
+    /* Earlier samples of the batch were converted while the CPU slept */
+    periph_charge(PERIPH_ADC, SUBSYS_SENSOR, 2000ull * (cfg->sensor_batch - 1));
+    periph_on(now, PERIPH_ADC, SUBSYS_SENSOR);
+    busy(SUBSYS_SENSOR, 2000);
+    periph_off(now, PERIPH_ADC);
+    busy(SUBSYS_SENSOR, 1000 * cfg->sensor_batch);
+}
+
+static void radio_task(const node_config_t *cfg) {
+    busy(SUBSYS_RADIO, 2000);
+    periph_on(now, PERIPH_RADIO_TX, SUBSYS_RADIO);
+    busy(SUBSYS_RADIO, cfg->radio_tx_us);      /* CPU drives the radio */
+    periph_off(now, PERIPH_RADIO_TX);
+}
+
+static void logger_task(void) {
+    periph_on(now, PERIPH_FLASH, SUBSYS_LOGGER);
+    busy(SUBSYS_LOGGER, 5000);
+    periph_off(now, PERIPH_FLASH);
+}
+
+static void run_node(const node_config_t *cfg) {
+    uint64_t next_sensor = 1000000ull * cfg->sensor_batch, next_radio = cfg->heartbeat_ms * 1000ull;
+    uint64_t next_log = 60000000, backlight_off = NO_EVENT;
+    uint32_t rng = 99;
+    uint64_t next_button = 20000000;
+
+    energy_init(&board_model);
+    now = 0;
+
+    while (now < SIM_US) {
+        uint64_t next = next_sensor;
+        if (next_radio < next)    next = next_radio;
+        if (next_log < next)      next = next_log;
+        if (backlight_off < next) next = backlight_off;
+        if (next_button < next)   next = next_button;
+
+        /* Idle until the next event (deadline known, as in 08) */
+        if (next > now) {
+            power_enter(now, next - now >= DEEP_SLEEP_MIN_US ? POWER_DEEP_SLEEP : POWER_SLEEP);
+            now = next;
+        }
+
+        if (now >= next_button) {
+            power_activity(now, SUBSYS_UI);
+            busy(SUBSYS_UI, 5000);
+            periph_on(now, PERIPH_LCD_BACKLIGHT, SUBSYS_UI);
+            backlight_off = now + cfg->backlight_ms * 1000ull;
+            rng = rng * 1664525u + 1013904223u;
+            next_button = now + 30000000ull + (uint64_t)((rng >> 8) % 90) * 1000000;
+        }
+        if (now >= backlight_off) {
+            power_activity(now, SUBSYS_UI);
+            busy(SUBSYS_UI, 200);
+            periph_off(now, PERIPH_LCD_BACKLIGHT);
+            backlight_off = NO_EVENT;
+        }
+        if (now >= next_sensor) {
+            power_activity(now, SUBSYS_SENSOR);
+            sensor_task(cfg);
+            next_sensor += 1000000ull * cfg->sensor_batch;
+        }
+        if (now >= next_radio) {
+            power_activity(now, SUBSYS_RADIO);
+            radio_task(cfg);
+            next_radio += cfg->heartbeat_ms * 1000ull;
+        }
+        if (now >= next_log) {
+            power_activity(now, SUBSYS_LOGGER);
+            logger_task();
+            next_log += 60000000;
+        }
+    }
+    energy_update(SIM_US > now ? SIM_US : now);
+}
+
+int main(void) {
+    static const node_config_t before = { .sensor_batch = 1,  .heartbeat_ms = 5000,
+                                          .radio_tx_us = 15000, .backlight_ms = 10000 };
+    static const node_config_t after  = { .sensor_batch = 10, .heartbeat_ms = 5000,
+                                          .radio_tx_us = 15000, .backlight_ms = 3000 };
+    double before_sub[SUBSYS_COUNT], before_total;
+
+    printf("=== Energy Accounting: Who Spends the Battery? ===\n\n");
+    printf("Model: CPU 50/25/5/0.01 mA, wake 0.25/15/2200 uC (IDLE/SLEEP/DEEP),\n"
+           "       ADC 1.5 mA, radio TX 12 mA, backlight 8 mA, flash 4 mA\n\n");
+
+    /* 1. Measure */
+    printf("--- 30 min: sensor wakes CPU every 1 s, heartbeat 5 s, backlight 10 s ---\n");
+    run_node(&before);
+    energy_report();
+    for (int s = 0; s < SUBSYS_COUNT; s++) before_sub[s] = energy_subsys_total((subsys_t)s);
+    before_total = energy.total_uc;
+
+    FILE *csv = fopen("energy_timeseries.csv", "w");
+    if (csv != NULL) {
+        energy_export_csv(csv);
+        fclose(csv);
+        printf("Time series: %u samples every %llu s -> energy_timeseries.csv\n",
+               energy.num_samples, ENERGY_SAMPLE_US / 1000000);
+    }
+
+    /* 2. Optimize what the report points at, and measure again */
+    printf("\nSensor wake-ups dominate; the backlight is next. The radio never wakes\n"
+           "the CPU itself: its 5 s heartbeat always lands on a sensor wake-up.\n");
+    printf("\n--- Same 30 min: sensor batched by ADC+DMA, CPU every 10 s; backlight 3 s ---\n");
+    run_node(&after);
+    energy_report();
+
+    printf("\n%-8s %10s %10s %8s\n", "subsys", "before uC", "after uC", "change");
+    for (int s = 0; s < SUBSYS_COUNT; s++) {
+        double a = energy_subsys_total((subsys_t)s);
+        printf("%-8s %10.0f %10.0f %7.0f%%\n", subsys_names[s], before_sub[s], a,
+               (a / before_sub[s] - 1.0) * 100.0);
+    }
+    printf("%-8s %10.0f %10.0f %7.0f%%\n", "total", before_total, energy.total_uc,
+           (energy.total_uc / before_total - 1.0) * 100.0);
+
+    printf("\n=== Energy Accounting Features ===\n");
+    printf("✅ Configurable current model: states, wake-ups, peripherals\n");
+    printf("✅ CPU charge attributed to the subsystem being served\n");
+    printf("✅ Peripheral charge attributed to the subsystem that enabled it\n");
+    printf("✅ Wake sources: count, wake charge, whole-episode charge\n");
+    printf("✅ Periodic cumulative samples, CSV export\n");
+    printf("✅ Before/after comparison of an optimization\n");
+
+    return 0;
+}
+
+/*
+ * ENERGY ACCOUNTING NOTES:
+ *
+ * 1. TWO VIEWS OF THE SAME CHARGE
+ *    - Consumer: who used the CPU / peripheral while it was on
+ *    - Wake source: who made the system leave sleep. A 3 ms sensor task
+ *      is cheap; waking from DEEP_SLEEP every second to run it is not
+ *
+ * 2. RULES THAT KEEP THE BOOKS BALANCED
+ *    - Every interval is integrated once, at the state and owners in
+ *      force during it: update the books BEFORE changing anything
+ *    - Sum of subsystem totals == total charge
+ *
+ * 3. SHARED WAKE-UPS
+ *    - When several events are due at one wake-up, the first one handled
+ *      is charged for it; the others ride along for free. Remove the
+ *      first and the next one shows up as a wake source
+ *
+ * 4. ON REAL HARDWARE
+ *    - Calibrate the model with a current probe once per board; the
+ *      accounting then runs on the device at almost no cost
+ *    - Export samples over the debug UART or store them in the log
+ */